@@ -0,0 +1,173 @@
+/*
+    This file is part of Akonadi Contact.
+
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "contactsearchindextest.h"
+
+#include "contactsearchindex_p.h"
+#include "contactsearchjob_p.h"
+
+#include <kcontacts/addressee.h>
+
+#include <qtest.h>
+
+QTEST_MAIN(ContactSearchIndexTest)
+
+using namespace Akonadi;
+
+Q_DECLARE_METATYPE(Akonadi::ContactSearchJob::Match)
+
+static Item contactItem(Item::Id id, const QString &givenName, const QString &familyName,
+                        const QString &nickName, const QStringList &emails)
+{
+    KContacts::Addressee contact;
+    contact.setGivenName(givenName);
+    contact.setFamilyName(familyName);
+    contact.setFormattedName(familyName + QStringLiteral(", ") + givenName);
+    contact.setNickName(nickName);
+    contact.setEmails(emails);
+
+    Item item(id);
+    item.setMimeType(KContacts::Addressee::mimeType());
+    item.setPayload<KContacts::Addressee>(contact);
+    return item;
+}
+
+static void fillIndex(ContactWordIndex &index)
+{
+    index.insert(contactItem(1, QStringLiteral("Tobias"), QStringLiteral("Koenig"), QStringLiteral("tokoe"),
+                             QStringList() << QStringLiteral("tokoe@kde.org") << QStringLiteral("tobias.koenig@example.com")));
+    index.insert(contactItem(2, QStringLiteral("Pat"), QStringLiteral("O'Brien"), QString(),
+                             QStringList() << QStringLiteral("pat.obrien@example.com")));
+    index.insert(contactItem(3, QStringLiteral("Jean-Luc"), QStringLiteral("Picard"), QStringLiteral("Captain"),
+                             QStringList() << QStringLiteral("jl.picard@enterprise.org")));
+    index.insert(contactItem(4, QStringLiteral("Jürgen"), QStringLiteral("Müller"), QStringLiteral("Tobi"),
+                             QStringList() << QStringLiteral("JUERGEN@MUELLER.DE")));
+    index.insert(contactItem(5, QStringLiteral("Anna"), QStringLiteral("Tobiassen"), QString(),
+                             QStringList() << QStringLiteral("anna@kde.org")));
+}
+
+// the contacts found the way ContactSearchJob searches an index
+static QSet<Item::Id> indexResults(const ContactWordIndex &index, const ContactSearchCriteria &criteria)
+{
+    const QString text = criteria.indexSearchText();
+    const Item::List candidates = text.isNull() ? index.items() : index.search(text);
+
+    QSet<Item::Id> ids;
+    foreach (const Item &item, candidates) {
+        if (criteria.matches(item.payload<KContacts::Addressee>())) {
+            ids.insert(item.id());
+        }
+    }
+    return ids;
+}
+
+// the contacts matching when every indexed contact is checked
+static QSet<Item::Id> allResults(const ContactWordIndex &index, const ContactSearchCriteria &criteria)
+{
+    QSet<Item::Id> ids;
+    foreach (const Item &item, index.items()) {
+        if (criteria.matches(item.payload<KContacts::Addressee>())) {
+            ids.insert(item.id());
+        }
+    }
+    return ids;
+}
+
+void ContactSearchIndexTest::indexSearchText()
+{
+    ContactSearchCriteria criteria;
+    criteria.addQuery(ContactSearchJob::Name, QStringLiteral("Jean-Luc Pic"), ContactSearchJob::StartsWithMatch);
+    QCOMPARE(criteria.indexSearchText(), QStringLiteral("jean luc pic"));
+
+    criteria.clear();
+    criteria.addQuery(ContactSearchJob::Name, QStringLiteral("luc"), ContactSearchJob::ContainsMatch);
+    QVERIFY(criteria.indexSearchText().isNull());
+
+    criteria.clear();
+    criteria.addQuery(ContactSearchJob::Email, QStringLiteral("@"), ContactSearchJob::StartsWithMatch);
+    QVERIFY(criteria.indexSearchText().isNull());
+
+    criteria.clear();
+    criteria.setRelation(ContactSearchJob::MatchAny);
+    criteria.addQuery(ContactSearchJob::Name, QStringLiteral("tob"), ContactSearchJob::StartsWithMatch);
+    criteria.addQuery(ContactSearchJob::Email, QStringLiteral("anna"), ContactSearchJob::StartsWithMatch);
+    QVERIFY(criteria.indexSearchText().isNull());
+}
+
+void ContactSearchIndexTest::matches_data()
+{
+    QTest::addColumn<ContactSearchJob::Match>("match");
+
+    QTest::newRow("exact") << ContactSearchJob::ExactMatch;
+    QTest::newRow("starts with") << ContactSearchJob::StartsWithMatch;
+    QTest::newRow("contains") << ContactSearchJob::ContainsMatch;
+    QTest::newRow("contains word boundary") << ContactSearchJob::ContainsWordBoundaryMatch;
+}
+
+void ContactSearchIndexTest::matches()
+{
+    QFETCH(ContactSearchJob::Match, match);
+
+    ContactWordIndex index;
+    fillIndex(index);
+
+    const QList<ContactSearchJob::Criterion> criterions = QList<ContactSearchJob::Criterion>()
+            << ContactSearchJob::Name << ContactSearchJob::Email
+            << ContactSearchJob::NickName << ContactSearchJob::NameOrEmail;
+
+    const QStringList values = QStringList()
+                               << QString() << QStringLiteral("tob") << QStringLiteral("TOBIAS")
+                               << QStringLiteral("Koenig, Tobias") << QStringLiteral("koenig, tob")
+                               << QStringLiteral("o'brien") << QStringLiteral("O'Br") << QStringLiteral("brien")
+                               << QStringLiteral("jean-luc") << QStringLiteral("luc pic") << QStringLiteral("Luc")
+                               << QStringLiteral("kde.org") << QStringLiteral("tokoe@kde") << QStringLiteral("tokoe@kde.org")
+                               << QStringLiteral("juergen@mueller.de") << QStringLiteral("MÜLLER") << QStringLiteral("mül")
+                               << QStringLiteral("captain") << QStringLiteral("@") << QStringLiteral(".com");
+
+    foreach (ContactSearchJob::Criterion criterion, criterions) {
+        foreach (const QString &value, values) {
+            ContactSearchCriteria criteria;
+            criteria.addQuery(criterion, value, match);
+
+            QVERIFY2(indexResults(index, criteria) == allResults(index, criteria),
+                     qPrintable(QStringLiteral("criterion %1, value '%2'").arg(criterion).arg(value)));
+        }
+    }
+}
+
+void ContactSearchIndexTest::matchAll()
+{
+    ContactWordIndex index;
+    fillIndex(index);
+
+    ContactSearchCriteria criteria;
+    criteria.addQuery(ContactSearchJob::Name, QStringLiteral("tob"), ContactSearchJob::StartsWithMatch);
+    criteria.addQuery(ContactSearchJob::Email, QStringLiteral("kde.org"), ContactSearchJob::ContainsWordBoundaryMatch);
+
+    const QSet<Item::Id> ids = indexResults(index, criteria);
+    QCOMPARE(ids, allResults(index, criteria));
+    QCOMPARE(ids, QSet<Item::Id>() << 1 << 5);
+
+    criteria.clear();
+    criteria.setRelation(ContactSearchJob::MatchAny);
+    criteria.addQuery(ContactSearchJob::NickName, QStringLiteral("Tobi"), ContactSearchJob::ExactMatch);
+    criteria.addQuery(ContactSearchJob::Email, QStringLiteral("org"), ContactSearchJob::ContainsWordBoundaryMatch);
+    QCOMPARE(indexResults(index, criteria), allResults(index, criteria));
+    QCOMPARE(indexResults(index, criteria), QSet<Item::Id>() << 1 << 3 << 4 << 5);
+}
@@ -0,0 +1,131 @@
+/*
+    This file is part of Akonadi Contact.
+
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "contactsfilterproxymodeltest.h"
+
+#include "contactsfilterproxymodel.h"
+
+#include <entitytreemodel.h>
+#include <kcontacts/addressee.h>
+
+#include <QStandardItemModel>
+#include <qtest.h>
+
+QTEST_MAIN(ContactsFilterProxyModelTest)
+
+using namespace Akonadi;
+
+static QStandardItem *contactItem(Item::Id id, const QString &name, const QString &email)
+{
+    KContacts::Addressee contact;
+    contact.setNameFromString(name);
+    contact.setFormattedName(name);
+    contact.insertEmail(email);
+
+    Item item(id);
+    item.setMimeType(KContacts::Addressee::mimeType());
+    item.setPayload<KContacts::Addressee>(contact);
+
+    QStandardItem *standardItem = new QStandardItem(name);
+    standardItem->setData(QVariant::fromValue(item), EntityTreeModel::ItemRole);
+    return standardItem;
+}
+
+// the ids of the items accepted by the proxy
+static QSet<Item::Id> acceptedIds(const QAbstractItemModel *model)
+{
+    QSet<Item::Id> ids;
+    for (int row = 0; row < model->rowCount(); ++row) {
+        ids.insert(model->index(row, 0).data(EntityTreeModel::ItemRole).value<Item>().id());
+    }
+    return ids;
+}
+
+// the ids accepted by a proxy that filters all rows from scratch
+static QSet<Item::Id> refilteredIds(QAbstractItemModel *sourceModel, const QString &filter)
+{
+    ContactsFilterProxyModel proxy;
+    proxy.setSourceModel(sourceModel);
+    proxy.setFilterString(filter);
+    return acceptedIds(&proxy);
+}
+
+ContactsFilterProxyModelTest::ContactsFilterProxyModelTest()
+    : mSourceModel(0)
+{
+}
+
+void ContactsFilterProxyModelTest::init()
+{
+    mSourceModel = new QStandardItemModel(this);
+    mSourceModel->appendRow(contactItem(1, QStringLiteral("Tobias Koenig"), QStringLiteral("tokoe@kde.org")));
+    mSourceModel->appendRow(contactItem(2, QStringLiteral("Anna Tobiassen"), QStringLiteral("anna@example.com")));
+    mSourceModel->appendRow(contactItem(3, QStringLiteral("Tom Anderson"), QStringLiteral("tom@example.org")));
+    mSourceModel->appendRow(contactItem(4, QStringLiteral("Jürgen Müller"), QStringLiteral("juergen@mueller.de")));
+    mSourceModel->appendRow(contactItem(5, QStringLiteral("Pat O'Brien"), QStringLiteral("PAT@EXAMPLE.COM")));
+}
+
+void ContactsFilterProxyModelTest::cleanup()
+{
+    delete mSourceModel;
+    mSourceModel = 0;
+}
+
+void ContactsFilterProxyModelTest::refineFilter()
+{
+    ContactsFilterProxyModel proxy;
+    proxy.setSourceModel(mSourceModel);
+    QCOMPARE(proxy.rowCount(), mSourceModel->rowCount());
+
+    // typed, extended, shortened, replaced and cleared
+    const QStringList filters = QStringList()
+                                << QStringLiteral("t") << QStringLiteral("to") << QStringLiteral("tob")
+                                << QStringLiteral("tobi") << QStringLiteral("to") << QStringLiteral("o")
+                                << QStringLiteral("example") << QStringLiteral("EXAMPLE.COM") << QStringLiteral("example.co")
+                                << QStringLiteral("mül") << QStringLiteral("xyz") << QStringLiteral("x")
+                                << QString() << QStringLiteral("an");
+
+    foreach (const QString &filter, filters) {
+        proxy.setFilterString(filter);
+        QVERIFY2(acceptedIds(&proxy) == refilteredIds(mSourceModel, filter), qPrintable(filter));
+    }
+
+    QCOMPARE(acceptedIds(&proxy), QSet<Item::Id>() << 2 << 3);
+}
+
+void ContactsFilterProxyModelTest::asynchronousFiltering()
+{
+    ContactsFilterProxyModel proxy;
+    proxy.setSourceModel(mSourceModel);
+    proxy.setFilterString(QStringLiteral("to"));
+    const QSet<Item::Id> ids = acceptedIds(&proxy);
+
+    // the rows matched synchronously stay until the worker is done
+    proxy.setAsynchronousFiltering(true);
+    QCOMPARE(acceptedIds(&proxy), ids);
+    QTest::qWait(100);
+    QCOMPARE(acceptedIds(&proxy), ids);
+
+    proxy.setFilterString(QStringLiteral("an"));
+    QTRY_COMPARE(acceptedIds(&proxy), refilteredIds(mSourceModel, QStringLiteral("an")));
+
+    mSourceModel->removeRow(1);
+    proxy.setFilterString(QStringLiteral("a"));
+    QTRY_COMPARE(acceptedIds(&proxy), refilteredIds(mSourceModel, QStringLiteral("a")));
+}
@@ -0,0 +1,380 @@
+/*
+    This file is part of Akonadi Contact.
+
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "contactstreemodeltest.h"
+
+#include "contactsfilterproxymodel.h"
+#include "contactstreemodel.h"
+#include "contactstreemodel_p.h"
+
+#include <changerecorder.h>
+#include <itemfetchscope.h>
+#include <itemmodifyjob.h>
+#include <qtest_akonadi.h>
+
+#include <kcontacts/addressee.h>
+#include <kcontacts/contactgroup.h>
+
+#include <QSignalSpy>
+#include <QSortFilterProxyModel>
+
+QTEST_AKONADIMAIN(ContactsTreeModelTest)
+
+using namespace Akonadi;
+
+// the contacts in unittestenv/kdehome/testdata.xml
+static const int s_contactCount = 7;
+
+static int itemCount(const QAbstractItemModel *model, const QModelIndex &parent = QModelIndex())
+{
+    int count = 0;
+    for (int row = 0; row < model->rowCount(parent); ++row) {
+        const QModelIndex index = model->index(row, 0, parent);
+        if (index.data(EntityTreeModel::ItemRole).value<Item>().isValid()) {
+            ++count;
+        } else {
+            count += itemCount(model, index);
+        }
+    }
+    return count;
+}
+
+// checks that every collection reports the expected column count, and
+// every item none
+static void verifyColumnCount(const QAbstractItemModel *model, int count, const QModelIndex &parent = QModelIndex())
+{
+    QCOMPARE(model->columnCount(parent), count);
+    for (int row = 0; row < model->rowCount(parent); ++row) {
+        const QModelIndex index = model->index(row, 0, parent);
+        if (index.data(EntityTreeModel::ItemRole).value<Item>().isValid()) {
+            QCOMPARE(model->columnCount(index), 0);
+        } else {
+            verifyColumnCount(model, count, index);
+        }
+    }
+}
+
+// the display texts of all rows in @p column, depth first
+static QStringList texts(const QAbstractItemModel *model, int column, const QModelIndex &parent = QModelIndex())
+{
+    QStringList result;
+    for (int row = 0; row < model->rowCount(parent); ++row) {
+        const QModelIndex index = model->index(row, 0, parent);
+        result << model->index(row, column, parent).data().toString();
+        if (!index.data(EntityTreeModel::ItemRole).value<Item>().isValid()) {
+            result << texts(model, column, index);
+        }
+    }
+    return result;
+}
+
+static QModelIndex findItem(const QAbstractItemModel *model, const QString &remoteId, const QModelIndex &parent = QModelIndex())
+{
+    for (int row = 0; row < model->rowCount(parent); ++row) {
+        const QModelIndex index = model->index(row, 0, parent);
+        const Item item = index.data(EntityTreeModel::ItemRole).value<Item>();
+        if (!item.isValid()) {
+            const QModelIndex found = findItem(model, remoteId, index);
+            if (found.isValid()) {
+                return found;
+            }
+        } else if (item.remoteId() == remoteId) {
+            return index;
+        }
+    }
+    return QModelIndex();
+}
+
+// the order ContactsFilterProxyModel has to sort birthdays in: by month and
+// day, and otherwise like QSortFilterProxyModel
+class BirthdaySortProxyModel : public QSortFilterProxyModel
+{
+protected:
+    bool lessThan(const QModelIndex &leftIndex, const QModelIndex &rightIndex) const Q_DECL_OVERRIDE
+    {
+        const QDate left = leftIndex.data(ContactsTreeModel::DateRole).toDate();
+        const QDate right = rightIndex.data(ContactsTreeModel::DateRole).toDate();
+        if (left.isValid() && right.isValid()) {
+            if (left.month() != right.month()) {
+                return left.month() < right.month();
+            } else if (left.day() != right.day()) {
+                return left.day() < right.day();
+            }
+        }
+
+        return QSortFilterProxyModel::lessThan(leftIndex, rightIndex);
+    }
+};
+
+// sorts @p proxy and @p reference by @p column and compares their order
+static void verifySorting(QSortFilterProxyModel *proxy, QSortFilterProxyModel *reference, int column)
+{
+    proxy->setSortLocaleAware(true);
+    proxy->sort(column);
+    reference->setSortLocaleAware(true);
+    reference->sort(column);
+
+    QCOMPARE(texts(proxy, column), texts(reference, column));
+    // contacts with equal values have to keep their order as well
+    QCOMPARE(texts(proxy, 0), texts(reference, 0));
+}
+
+ColumnChangeChecker::ColumnChangeChecker(QAbstractItemModel *model)
+    : mModel(model)
+{
+    connect(model, SIGNAL(columnsAboutToBeInserted(QModelIndex,int,int)),
+            this, SLOT(columnsAboutToBeChanged(QModelIndex)));
+    connect(model, SIGNAL(columnsAboutToBeRemoved(QModelIndex,int,int)),
+            this, SLOT(columnsAboutToBeChanged(QModelIndex)));
+    connect(model, SIGNAL(columnsInserted(QModelIndex,int,int)),
+            this, SLOT(columnsInserted(QModelIndex,int,int)));
+    connect(model, SIGNAL(columnsRemoved(QModelIndex,int,int)),
+            this, SLOT(columnsRemoved(QModelIndex,int,int)));
+}
+
+void ColumnChangeChecker::snapshot()
+{
+    mLayouts.clear();
+    snapshot(QModelIndex());
+}
+
+void ColumnChangeChecker::snapshot(const QModelIndex &parent)
+{
+    mLayouts.insert(parent, layout(parent));
+    for (int row = 0; row < mModel->rowCount(parent); ++row) {
+        const QModelIndex index = mModel->index(row, 0, parent);
+        if (!index.data(EntityTreeModel::ItemRole).value<Item>().isValid()) {
+            snapshot(index);
+        }
+    }
+}
+
+ColumnChangeChecker::Layout ColumnChangeChecker::layout(const QModelIndex &parent) const
+{
+    Layout layout;
+    layout.columnCount = mModel->columnCount(parent);
+    for (int row = 0; row < mModel->rowCount(parent); ++row) {
+        if (!mModel->index(row, 0, parent).data(EntityTreeModel::ItemRole).value<Item>().isValid()) {
+            continue;
+        }
+
+        QStringList texts;
+        for (int column = 0; column < layout.columnCount; ++column) {
+            texts << mModel->index(row, column, parent).data().toString();
+        }
+        layout.rows.insert(row, texts);
+    }
+    return layout;
+}
+
+void ColumnChangeChecker::verify(const QModelIndex &parent, const Layout &expected) const
+{
+    const Layout actual = layout(parent);
+    QCOMPARE(actual.columnCount, expected.columnCount);
+    QCOMPARE(actual.rows, expected.rows);
+}
+
+void ColumnChangeChecker::columnsAboutToBeChanged(const QModelIndex &parent)
+{
+    QVERIFY(mLayouts.contains(parent));
+    verify(parent, mLayouts.value(parent));
+}
+
+void ColumnChangeChecker::columnsInserted(const QModelIndex &parent, int first, int last)
+{
+    Layout expected = mLayouts.value(parent);
+    expected.columnCount += last - first + 1;
+
+    // the texts of the new columns are taken over, the others must be kept
+    const Layout actual = layout(parent);
+    QMap<int, QStringList>::iterator it = expected.rows.begin();
+    for (; it != expected.rows.end(); ++it) {
+        for (int column = first; column <= last; ++column) {
+            it->insert(column, actual.rows.value(it.key()).value(column));
+        }
+    }
+
+    verify(parent, expected);
+    mLayouts.insert(parent, expected);
+}
+
+void ColumnChangeChecker::columnsRemoved(const QModelIndex &parent, int first, int last)
+{
+    Layout expected = mLayouts.value(parent);
+    expected.columnCount -= last - first + 1;
+
+    QMap<int, QStringList>::iterator it = expected.rows.begin();
+    for (; it != expected.rows.end(); ++it) {
+        it->erase(it->begin() + first, it->begin() + last + 1);
+    }
+
+    verify(parent, expected);
+    mLayouts.insert(parent, expected);
+}
+
+ContactsTreeModelTest::ContactsTreeModelTest()
+    : mChangeRecorder(0)
+    , mModel(0)
+{
+}
+
+void ContactsTreeModelTest::initTestCase()
+{
+    AkonadiTest::checkTestIsIsolated();
+}
+
+void ContactsTreeModelTest::init()
+{
+    mChangeRecorder = new ChangeRecorder(this);
+    mChangeRecorder->fetchCollection(true);
+    mChangeRecorder->itemFetchScope().fetchFullPayload();
+    mChangeRecorder->setCollectionMonitored(Collection::root());
+    mChangeRecorder->setMimeTypeMonitored(KContacts::Addressee::mimeType(), true);
+    mChangeRecorder->setMimeTypeMonitored(KContacts::ContactGroup::mimeType(), true);
+
+    mModel = new ContactsTreeModel(mChangeRecorder, this);
+    QTRY_COMPARE_WITH_TIMEOUT(itemCount(mModel), s_contactCount, 10000);
+}
+
+void ContactsTreeModelTest::cleanup()
+{
+    delete mModel;
+    mModel = 0;
+    delete mChangeRecorder;
+    mChangeRecorder = 0;
+}
+
+void ContactsTreeModelTest::changeColumns()
+{
+    ColumnChangeChecker checker(mModel);
+
+    ContactsFilterProxyModel proxy;
+    proxy.setSourceModel(mModel);
+
+    QSignalSpy resetSpy(mModel, SIGNAL(modelReset()));
+    QSignalSpy insertSpy(mModel, SIGNAL(columnsInserted(QModelIndex,int,int)));
+    QSignalSpy removeSpy(mModel, SIGNAL(columnsRemoved(QModelIndex,int,int)));
+
+    // added after the kept column
+    checker.snapshot();
+    mModel->setColumns(ContactsTreeModel::Columns() << ContactsTreeModel::FullName
+                       << ContactsTreeModel::FamilyName << ContactsTreeModel::AllEmails);
+    verifyColumnCount(mModel, 3);
+    verifyColumnCount(&proxy, 3);
+    QVERIFY(!insertSpy.isEmpty());
+
+    // removed from the middle, added in front
+    checker.snapshot();
+    mModel->setColumns(ContactsTreeModel::Columns() << ContactsTreeModel::GivenName
+                       << ContactsTreeModel::FullName << ContactsTreeModel::AllEmails);
+    verifyColumnCount(mModel, 3);
+    verifyColumnCount(&proxy, 3);
+    QVERIFY(!removeSpy.isEmpty());
+
+    // removed on both sides
+    checker.snapshot();
+    mModel->setColumns(ContactsTreeModel::Columns() << ContactsTreeModel::FullName);
+    verifyColumnCount(mModel, 1);
+    verifyColumnCount(&proxy, 1);
+
+    QCOMPARE(resetSpy.count(), 0);
+    QCOMPARE(itemCount(mModel), s_contactCount);
+    QCOMPARE(itemCount(&proxy), s_contactCount);
+
+    // reordering still resets the model
+    mModel->setColumns(ContactsTreeModel::Columns() << ContactsTreeModel::FullName << ContactsTreeModel::GivenName);
+    mModel->setColumns(ContactsTreeModel::Columns() << ContactsTreeModel::GivenName << ContactsTreeModel::FullName);
+    QCOMPARE(resetSpy.count(), 1);
+    verifyColumnCount(mModel, 2);
+}
+
+void ContactsTreeModelTest::sortByDisplayText()
+{
+    mModel->setColumns(ContactsTreeModel::Columns() << ContactsTreeModel::FullName << ContactsTreeModel::Birthday);
+
+    ContactsFilterProxyModel proxy;
+    proxy.setSourceModel(mModel);
+    QSortFilterProxyModel reference;
+    reference.setSourceModel(mModel);
+
+    // the proxy compares the collation keys instead of the texts
+    const QModelIndex index = findItem(mModel, QStringLiteral("anna"));
+    QVERIFY(index.isValid());
+    QVERIFY(index.data(CollationKeyRole).value<ContactCollationKey>().isValid());
+
+    verifySorting(&proxy, &reference, 0);
+}
+
+void ContactsTreeModelTest::sortByBirthday()
+{
+    mModel->setColumns(ContactsTreeModel::Columns() << ContactsTreeModel::FullName << ContactsTreeModel::Birthday);
+
+    ContactsFilterProxyModel proxy;
+    proxy.setSourceModel(mModel);
+    BirthdaySortProxyModel reference;
+    reference.setSourceModel(mModel);
+
+    // tom and eric share their birthday, elodie only its month and day
+    const QModelIndex tom = findItem(mModel, QStringLiteral("tom"));
+    const QModelIndex eric = findItem(mModel, QStringLiteral("eric"));
+    const QModelIndex elodie = findItem(mModel, QStringLiteral("elodie"));
+    QVERIFY(tom.isValid() && eric.isValid() && elodie.isValid());
+    QCOMPARE(tom.sibling(tom.row(), 1).data(BirthdaySortRole), eric.sibling(eric.row(), 1).data(BirthdaySortRole));
+    QCOMPARE(tom.sibling(tom.row(), 1).data(BirthdaySortRole), elodie.sibling(elodie.row(), 1).data(BirthdaySortRole));
+
+    verifySorting(&proxy, &reference, 1);
+}
+
+void ContactsTreeModelTest::changeItem()
+{
+    mModel->setColumns(ContactsTreeModel::Columns() << ContactsTreeModel::FullName << ContactsTreeModel::Birthday);
+
+    ContactsFilterProxyModel proxy;
+    proxy.setSourceModel(mModel);
+    QSortFilterProxyModel reference;
+    reference.setSourceModel(mModel);
+    verifySorting(&proxy, &reference, 0);
+
+    const QPersistentModelIndex index = findItem(mModel, QStringLiteral("tom"));
+    QVERIFY(index.isValid());
+    QCOMPARE(index.data().toString(), QStringLiteral("Tom Anderson"));
+
+    Item item = index.data(EntityTreeModel::ItemRole).value<Item>();
+    KContacts::Addressee contact = item.payload<KContacts::Addressee>();
+    contact.setGivenName(QStringLiteral("Aaron"));
+    contact.setFormattedName(QStringLiteral("Aaron Anderson"));
+    contact.setBirthday(QDateTime(QDate(1975, 1, 2)));
+    item.setPayload(contact);
+
+    ItemModifyJob *job = new ItemModifyJob(item, this);
+    AKVERIFYEXEC(job);
+
+    // the values cached for the previous revision must not be used anymore
+    QTRY_COMPARE_WITH_TIMEOUT(index.data().toString(), QStringLiteral("Aaron Anderson"), 10000);
+    const QModelIndex birthday = index.sibling(index.row(), 1);
+    QCOMPARE(birthday.data(ContactsTreeModel::DateRole).toDate(), QDate(1975, 1, 2));
+    QCOMPARE(birthday.data(BirthdaySortRole).toInt(), (1 << 5) | 2);
+
+    // the proxies are sorted again with the new collation key and birthday
+    QCOMPARE(texts(&proxy, 0), texts(&reference, 0));
+
+    BirthdaySortProxyModel birthdayReference;
+    birthdayReference.setSourceModel(mModel);
+    verifySorting(&proxy, &birthdayReference, 1);
+}
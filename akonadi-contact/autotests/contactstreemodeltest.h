@@ -0,0 +1,94 @@
+/*
+    This file is part of Akonadi Contact.
+
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef CONTACTSTREEMODELTEST_H
+#define CONTACTSTREEMODELTEST_H
+
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QModelIndex>
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+
+class QAbstractItemModel;
+
+namespace Akonadi
+{
+class ChangeRecorder;
+class ContactsTreeModel;
+}
+
+/**
+ * Checks that each parent of a model reports its previous columns until it
+ * is notified of a column change, and its new columns afterwards.
+ */
+class ColumnChangeChecker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ColumnChangeChecker(QAbstractItemModel *model);
+
+    /**
+     * Records the current columns of all parents.
+     */
+    void snapshot();
+
+private Q_SLOTS:
+    void columnsAboutToBeChanged(const QModelIndex &parent);
+    void columnsInserted(const QModelIndex &parent, int first, int last);
+    void columnsRemoved(const QModelIndex &parent, int first, int last);
+
+private:
+    struct Layout {
+        int columnCount;
+        // the display texts of the item rows
+        QMap<int, QStringList> rows;
+    };
+
+    Layout layout(const QModelIndex &parent) const;
+    void snapshot(const QModelIndex &parent);
+    void verify(const QModelIndex &parent, const Layout &expected) const;
+
+    QAbstractItemModel *mModel;
+    QHash<QModelIndex, Layout> mLayouts;
+};
+
+class ContactsTreeModelTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    ContactsTreeModelTest();
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void changeColumns();
+    void sortByDisplayText();
+    void sortByBirthday();
+    void changeItem();
+
+private:
+    Akonadi::ChangeRecorder *mChangeRecorder;
+    Akonadi::ContactsTreeModel *mModel;
+};
+
+#endif
@@ -0,0 +1,153 @@
+/*
+    This file is part of Akonadi Contact.
+
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "contactgroupexpandcache_p.h"
+
+#include <monitor.h>
+
+#include <kcontacts/contactgroup.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QPointer>
+
+using namespace Akonadi;
+
+// Total number of cached contacts, over all groups
+static const int s_maximumCachedContacts = 10000;
+
+ContactGroupExpandCache *ContactGroupExpandCache::instance()
+{
+    // owned by the application, so the monitor goes away before the session does
+    static QPointer<ContactGroupExpandCache> s_instance;
+    if (!s_instance) {
+        s_instance = new ContactGroupExpandCache(QCoreApplication::instance());
+    }
+
+    return s_instance;
+}
+
+ContactGroupExpandCache::ContactGroupExpandCache(QObject *parent)
+    : QObject(parent)
+    , mEntries(s_maximumCachedContacts)
+    , mContacts(s_maximumCachedContacts)
+    , mMonitor(0)
+{
+}
+
+bool ContactGroupExpandCache::lookup(const Item &group, KContacts::Addressee::List *contacts) const
+{
+    const Entry *entry = mEntries.object(group.id());
+    if (!entry || entry->revision != group.revision()) {
+        return false;
+    }
+
+    *contacts = entry->contacts;
+    return true;
+}
+
+void ContactGroupExpandCache::insert(const Item &group, const KContacts::Addressee::List &contacts,
+                                     const QSet<Item::Id> &members)
+{
+    if (!group.isValid()) {
+        return;
+    }
+
+    createMonitor();
+
+    Entry *entry = new Entry;
+    entry->revision = group.revision();
+    entry->contacts = contacts;
+    entry->members = members;
+    mEntries.insert(group.id(), entry, qMax(1, contacts.count()));
+}
+
+bool ContactGroupExpandCache::lookupContact(Item::Id id, const QString &gid, Item *contact) const
+{
+    if (!gid.isEmpty()) {
+        id = mContactGids.value(gid, -1);
+    }
+
+    const Item *item = mContacts.object(id);
+    if (!item) {
+        return false;
+    }
+
+    *contact = *item;
+    return true;
+}
+
+void ContactGroupExpandCache::insertContact(const Item &contact)
+{
+    if (!contact.isValid() || !contact.hasPayload<KContacts::Addressee>()) {
+        return;
+    }
+
+    createMonitor();
+
+    mContacts.insert(contact.id(), new Item(contact));
+    if (!contact.gid().isEmpty()) {
+        mContactGids.insert(contact.gid(), contact.id());
+    }
+
+    // drop the gids of contacts that fell out of the cache
+    if (mContactGids.count() > 2 * s_maximumCachedContacts) {
+        QHash<QString, Item::Id>::iterator it = mContactGids.begin();
+        while (it != mContactGids.end()) {
+            if (mContacts.contains(it.value())) {
+                ++it;
+            } else {
+                it = mContactGids.erase(it);
+            }
+        }
+    }
+}
+
+void ContactGroupExpandCache::createMonitor()
+{
+    if (mMonitor) {
+        return;
+    }
+
+    mMonitor = new Monitor(this);
+    mMonitor->setMimeTypeMonitored(KContacts::Addressee::mimeType());
+    mMonitor->setMimeTypeMonitored(KContacts::ContactGroup::mimeType());
+
+    connect(mMonitor, &Monitor::itemChanged, this, &ContactGroupExpandCache::itemChanged);
+    connect(mMonitor, &Monitor::itemRemoved, this, &ContactGroupExpandCache::itemChanged);
+    connect(mMonitor, &Monitor::collectionRemoved, this, &ContactGroupExpandCache::clear);
+}
+
+void ContactGroupExpandCache::itemChanged(const Item &item)
+{
+    mEntries.remove(item.id());
+    mContacts.remove(item.id());
+
+    foreach (Item::Id id, mEntries.keys()) {
+        if (mEntries.object(id)->members.contains(item.id())) {
+            mEntries.remove(id);
+        }
+    }
+}
+
+void ContactGroupExpandCache::clear()
+{
+    mEntries.clear();
+    mContacts.clear();
+    mContactGids.clear();
+}
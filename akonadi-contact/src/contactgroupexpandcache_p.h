@@ -0,0 +1,105 @@
+/*
+    This file is part of Akonadi Contact.
+
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef AKONADI_CONTACTGROUPEXPANDCACHE_P_H
+#define AKONADI_CONTACTGROUPEXPANDCACHE_P_H
+
+#include <item.h>
+
+#include <kcontacts/addressee.h>
+
+#include <QtCore/QCache>
+#include <QtCore/QObject>
+#include <QtCore/QSet>
+
+namespace Akonadi
+{
+
+class Monitor;
+
+/**
+ * @internal
+ *
+ * Caches the result of expanding contact groups, keyed by the id and
+ * revision of the group item, as well as the contacts that group members
+ * were resolved to.
+ *
+ * A Monitor watches all contacts and contact groups, and an entry is
+ * dropped as soon as the group itself or one of the items it was
+ * expanded from changes or is removed.
+ */
+class ContactGroupExpandCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static ContactGroupExpandCache *instance();
+
+    /**
+     * Returns whether an expansion for the revision of @p group is cached,
+     * and stores it in @p contacts in that case.
+     */
+    bool lookup(const Akonadi::Item &group, KContacts::Addressee::List *contacts) const;
+
+    /**
+     * Caches the expansion of @p group, which resolved to @p contacts from
+     * the items with the ids @p members.
+     */
+    void insert(const Akonadi::Item &group, const KContacts::Addressee::List &contacts,
+                const QSet<Akonadi::Item::Id> &members);
+
+    /**
+     * Returns whether the contact with the given item @p id (or @p gid, if
+     * not empty) is cached, and stores it in @p contact in that case.
+     *
+     * Cached contacts are only guaranteed to contain the data of the
+     * Akonadi::ContactPart::Lookup part.
+     */
+    bool lookupContact(Akonadi::Item::Id id, const QString &gid, Akonadi::Item *contact) const;
+
+    /**
+     * Caches the group member @p contact, an item with a
+     * KContacts::Addressee payload.
+     */
+    void insertContact(const Akonadi::Item &contact);
+
+private Q_SLOTS:
+    void itemChanged(const Akonadi::Item &item);
+    void clear();
+
+private:
+    explicit ContactGroupExpandCache(QObject *parent);
+
+    void createMonitor();
+
+    struct Entry {
+        int revision;
+        KContacts::Addressee::List contacts;
+        QSet<Akonadi::Item::Id> members;
+    };
+
+    QCache<Akonadi::Item::Id, Entry> mEntries;
+    QCache<Akonadi::Item::Id, Akonadi::Item> mContacts;
+    QHash<QString, Akonadi::Item::Id> mContactGids;
+    Monitor *mMonitor;
+};
+
+}
+
+#endif
@@ -21,6 +21,8 @@
 
 #include "contactgroupexpandjob.h"
 #include "akonadi_contact_debug.h"
+#include "contactgroupexpandcache_p.h"
+#include "contactparts.h"
 #include <contactgroupsearchjob.h>
 #include <itemfetchjob.h>
 #include <itemfetchscope.h>
@@ -28,58 +30,169 @@
 
 using namespace Akonadi;
 
+// Upper bound for the number of items fetched by a single job, and for the
+// number of jobs running at the same time while resolving one nesting level.
+static const int s_maximumFetchSize = 250;
+static const int s_maximumConcurrentFetches = 4;
+
 class Q_DECL_HIDDEN ContactGroupExpandJob::Private
 {
 public:
+    struct Reference {
+        Item::Id id;
+        QString gid;
+        QString preferredEmail;
+    };
+
+    struct PendingFetch {
+        Item::List items;
+        bool fullPayload;
+    };
+
     Private(const KContacts::ContactGroup &group, ContactGroupExpandJob *parent)
         : mParent(parent)
         , mGroup(group)
-        , mFetchCount(0)
+        , mRunningFetches(0)
+        , mIncomplete(false)
     {
     }
 
     Private(const QString &name, ContactGroupExpandJob *parent)
         : mParent(parent)
         , mName(name)
-        , mFetchCount(0)
+        , mRunningFetches(0)
+        , mIncomplete(false)
     {
     }
 
+    Private(const Item &item, ContactGroupExpandJob *parent)
+        : mParent(parent)
+        , mGroupItem(item)
+        , mRunningFetches(0)
+        , mIncomplete(false)
+    {
+        if (item.hasPayload<KContacts::ContactGroup>()) {
+            mGroup = item.payload<KContacts::ContactGroup>();
+        }
+    }
+
     void resolveGroup()
     {
-        for (unsigned int i = 0; i < mGroup.dataCount(); ++i) {
-            const KContacts::ContactGroup::Data data = mGroup.data(i);
+        if (mGroupItem.isValid()) {
+            if (ContactGroupExpandCache::instance()->lookup(mGroupItem, &mContacts)) {
+                mParent->emitResult();
+                return;
+            }
+            mVisitedGroups.insert(mGroupItem.id());
+        }
 
-            KContacts::Addressee contact;
-            contact.setNameFromString(data.name());
-            contact.insertEmail(data.email(), true);
+        resolveGroups(KContacts::ContactGroup::List() << mGroup);
+    }
 
-            mContacts.append(contact);
-        }
+    /**
+     * Resolves the members of all groups of one nesting level. Nested groups
+     * found on the way are resolved afterwards as the next level.
+     */
+    void resolveGroups(const KContacts::ContactGroup::List &groups)
+    {
+        // An item fetch job can only identify its items either by id or by gid,
+        // so references are fetched in separate batches for both.
+        Item::List itemsById;
+        Item::List itemsByGid;
+        Item::List groupItems;
+        ContactGroupExpandCache *cache = ContactGroupExpandCache::instance();
+
+        foreach (const KContacts::ContactGroup &group, groups) {
+            for (unsigned int i = 0; i < group.dataCount(); ++i) {
+                const KContacts::ContactGroup::Data data = group.data(i);
+
+                KContacts::Addressee contact;
+                contact.setNameFromString(data.name());
+                contact.insertEmail(data.email(), true);
+
+                addContact(contact);
+            }
 
-        for (unsigned int i = 0; i < mGroup.contactReferenceCount(); ++i) {
-            const KContacts::ContactGroup::ContactReference reference = mGroup.contactReference(i);
+            for (unsigned int i = 0; i < group.contactReferenceCount(); ++i) {
+                const KContacts::ContactGroup::ContactReference contactReference = group.contactReference(i);
 
-            Item item;
-            if (!reference.gid().isEmpty()) {
-                item.setGid(reference.gid());
-            } else {
-                item.setId(reference.uid().toLongLong());
+                Reference reference;
+                reference.id = -1;
+                reference.preferredEmail = contactReference.preferredEmail();
+                if (!contactReference.gid().isEmpty()) {
+                    reference.gid = contactReference.gid();
+                } else {
+                    reference.id = contactReference.uid().toLongLong();
+                }
+                mReferences.append(reference);
+
+                Item item;
+                if (cache->lookupContact(reference.id, reference.gid, &item)) {
+                    addFetchedItem(item);
+                } else if (!reference.gid.isEmpty()) {
+                    item.setGid(reference.gid);
+                    itemsByGid.append(item);
+                } else {
+                    item.setId(reference.id);
+                    itemsById.append(item);
+                }
             }
-            ItemFetchJob *job = new ItemFetchJob(item, mParent);
-            job->fetchScope().fetchFullPayload();
-            job->setProperty("preferredEmail", reference.preferredEmail());
 
-            mParent->connect(job, SIGNAL(result(KJob*)), mParent, SLOT(fetchResult(KJob*)));
+            for (unsigned int i = 0; i < group.contactGroupReferenceCount(); ++i) {
+                const Item::Id id = group.contactGroupReference(i).uid().toLongLong();
+                if (!mVisitedGroups.contains(id)) {
+                    mVisitedGroups.insert(id);
+                    mGroupReferences.append(id);
+                    groupItems.append(Item(id));
+                }
+            }
+        }
 
-            mFetchCount++;
+        enqueueFetches(itemsById, false);
+        enqueueFetches(itemsByGid, false);
+        enqueueFetches(groupItems, true);
+
+        if (mPendingFetches.isEmpty()) {   // nothing to fetch, so we can return immediately
+            finishLevel();
+            return;
         }
 
-        if (mFetchCount == 0) {   // nothing to fetch, so we can return immediately
-            mParent->emitResult();
+        while (mRunningFetches < s_maximumConcurrentFetches && !mPendingFetches.isEmpty()) {
+            startFetch();
+        }
+    }
+
+    void enqueueFetches(const Item::List &items, bool fullPayload)
+    {
+        for (int i = 0; i < items.count(); i += s_maximumFetchSize) {
+            PendingFetch fetch;
+            fetch.items = items.mid(i, s_maximumFetchSize);
+            fetch.fullPayload = fullPayload;
+            mPendingFetches.append(fetch);
         }
     }
 
+    void startFetch()
+    {
+        const PendingFetch fetch = mPendingFetches.takeFirst();
+
+        ItemFetchJob *job = new ItemFetchJob(fetch.items, mParent);
+        // Only name and email addresses are needed to expand the group,
+        // unless the contact does not provide the lookup part.
+        if (fetch.fullPayload) {
+            job->fetchScope().fetchFullPayload();
+        } else {
+            job->fetchScope().fetchPayloadPart(ContactPart::Lookup);
+        }
+        job->fetchScope().setFetchGid(true);
+        job->fetchScope().setIgnoreRetrievalErrors(true);
+        job->setProperty("fullPayload", fetch.fullPayload);
+
+        mParent->connect(job, SIGNAL(result(KJob*)), mParent, SLOT(fetchResult(KJob*)));
+
+        mRunningFetches++;
+    }
+
     void searchResult(KJob *job)
     {
         if (job->error()) {
@@ -97,6 +210,7 @@ public:
         }
 
         mGroup = searchJob->contactGroups().at(0);
+        mGroupItem = searchJob->items().at(0);
         resolveGroup();
     }
 
@@ -104,36 +218,131 @@ public:
     {
         const ItemFetchJob *fetchJob = qobject_cast<ItemFetchJob *>(job);
 
-        const Item::List items = fetchJob->items();
-        if (!items.isEmpty()) {
-            const QString email = fetchJob->property("preferredEmail").toString();
+        if (job->error()) {
+            // the job fails if none of the referenced items exist anymore
+            qCWarning(AKONADICONTACT_LOG) << "Unable to fetch members of group:" << job->errorText();
+        }
 
-            const Item item = items.first();
+        Item::List incompleteItems;
+        foreach (const Item &item, fetchJob->items()) {
             if (item.hasPayload<KContacts::Addressee>()) {
-                KContacts::Addressee contact = item.payload<KContacts::Addressee>();
-                if (!email.isEmpty()) {
-                    contact.insertEmail(email, true);
+                ContactGroupExpandCache::instance()->insertContact(item);
+                addFetchedItem(item);
+            } else if (item.hasPayload<KContacts::ContactGroup>()) {
+                addFetchedItem(item);
+            } else if (!fetchJob->property("fullPayload").toBool()) {
+                // no lookup part, or a contact reference pointing to a group
+                incompleteItems.append(Item(item.id()));
+            }
+        }
+        enqueueFetches(incompleteItems, true);
+
+        mRunningFetches--;
+
+        while (mRunningFetches < s_maximumConcurrentFetches && !mPendingFetches.isEmpty()) {
+            startFetch();
+        }
+
+        if (mRunningFetches == 0) {
+            finishLevel();
+        }
+    }
+
+    void finishLevel()
+    {
+        KContacts::ContactGroup::List nestedGroups;
+
+        foreach (const Reference &reference, mReferences) {
+            const Item::Id id = reference.gid.isEmpty() ? reference.id : mFetchedGids.value(reference.gid, -1);
+            const QHash<Item::Id, Item>::const_iterator it = mFetchedItems.constFind(id);
+            if (it == mFetchedItems.constEnd()) {
+                qCWarning(AKONADICONTACT_LOG) << "Contact for Akonadi item" << (reference.gid.isEmpty() ? QString::number(reference.id) : reference.gid)
+                                              << "does not exist anymore!";
+                mIncomplete = true;
+                continue;
+            }
+
+            if (it.value().hasPayload<KContacts::ContactGroup>()) {
+                if (!mVisitedGroups.contains(id)) {
+                    mVisitedGroups.insert(id);
+                    nestedGroups.append(it.value().payload<KContacts::ContactGroup>());
                 }
+                continue;
+            }
+
+            KContacts::Addressee contact = it.value().payload<KContacts::Addressee>();
+            if (!reference.preferredEmail.isEmpty()) {
+                contact.insertEmail(reference.preferredEmail, true);
+            }
+
+            addContact(contact);
+        }
 
-                mContacts.append(contact);
+        foreach (Item::Id id, mGroupReferences) {
+            const Item item = mFetchedItems.value(id);
+            if (item.hasPayload<KContacts::ContactGroup>()) {
+                nestedGroups.append(item.payload<KContacts::ContactGroup>());
             } else {
-                qCWarning(AKONADICONTACT_LOG) << "Contact for Akonadi item" << item.id() << "does not exist anymore!";
+                qCWarning(AKONADICONTACT_LOG) << "Contact group for Akonadi item" << id << "does not exist anymore!";
+                mIncomplete = true;
             }
         }
 
-        mFetchCount--;
+        mReferences.clear();
+        mGroupReferences.clear();
+        mFetchedItems.clear();
+        mFetchedGids.clear();
 
-        if (mFetchCount == 0) {
+        if (nestedGroups.isEmpty()) {
+            // a later added contact might resolve the missing references
+            if (mGroupItem.isValid() && !mIncomplete) {
+                ContactGroupExpandCache::instance()->insert(mGroupItem, mContacts, mMembers);
+            }
             mParent->emitResult();
+        } else {
+            resolveGroups(nestedGroups);
+        }
+    }
+
+    void addFetchedItem(const Item &item)
+    {
+        mFetchedItems.insert(item.id(), item);
+        mMembers.insert(item.id());
+        if (!item.gid().isEmpty()) {
+            mFetchedGids.insert(item.gid(), item.id());
+        }
+    }
+
+    void addContact(const KContacts::Addressee &contact)
+    {
+        const QString email = contact.preferredEmail().toLower();
+        if (!email.isEmpty()) {
+            if (mEmails.contains(email)) {
+                return;
+            }
+            mEmails.insert(email);
         }
+
+        mContacts.append(contact);
     }
 
     ContactGroupExpandJob *mParent;
     KContacts::ContactGroup mGroup;
+    Item mGroupItem;
     QString mName;
     KContacts::Addressee::List mContacts;
-
-    int mFetchCount;
+    QSet<QString> mEmails;
+    QSet<Item::Id> mVisitedGroups;
+    QSet<Item::Id> mMembers;
+
+    // state of the nesting level being resolved
+    QVector<Reference> mReferences;
+    QVector<Item::Id> mGroupReferences;
+    QList<PendingFetch> mPendingFetches;
+    QHash<Item::Id, Item> mFetchedItems;
+    QHash<QString, Item::Id> mFetchedGids;
+    int mRunningFetches;
+    bool mIncomplete;
 };
 
 ContactGroupExpandJob::ContactGroupExpandJob(const KContacts::ContactGroup &group, QObject *parent)
@@ -148,6 +357,12 @@ ContactGroupExpandJob::ContactGroupExpandJob(const QString &name, QObject *paren
 {
 }
 
+ContactGroupExpandJob::ContactGroupExpandJob(const Item &group, QObject *parent)
+    : KJob(parent)
+    , d(new Private(group, this))
+{
+}
+
 ContactGroupExpandJob::~ContactGroupExpandJob()
 {
     delete d;
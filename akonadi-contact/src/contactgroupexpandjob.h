@@ -24,6 +24,7 @@
 
 #include "akonadi-contact_export.h"
 
+#include <item.h>
 #include <kcontacts/addressee.h>
 #include <kcontacts/contactgroup.h>
 #include <kjob.h>
@@ -37,9 +38,16 @@ namespace Akonadi
  * This job takes a KContacts::ContactGroup object or a name of a contact group and
  * expands it to a list of KContacts::Addressee objects by creating temporary KContacts::Addressee objects
  * for the KContacts::ContactGroup::Data objects of the group and fetching the
- * complete contacts from the Akonadi storage for the
+ * contacts from the Akonadi storage for the
  * KContacts::ContactGroup::ContactReferences of the group.
  *
+ * Nested contact groups are expanded recursively, each group at most once.
+ * The returned list contains every email address only once.
+ *
+ * References are fetched in batches, and only with the parts needed for
+ * addressing (see Akonadi::ContactPart::Lookup), so the returned contacts
+ * are only guaranteed to contain names and email addresses.
+ *
  * @code
  *
  * const KContacts::ContactGroup group = ...;
@@ -85,6 +93,20 @@ public:
      */
     explicit ContactGroupExpandJob(const QString &name, QObject *parent = Q_NULLPTR);
 
+    /**
+     * Creates a new contact group expand job.
+     *
+     * Expanding a contact group item allows the job to reuse the result of a
+     * previous expansion of the same revision of the group, as long as none
+     * of its members changed in the meantime.
+     *
+     * @param group The contact group item to expand, with the KContacts::ContactGroup payload.
+     * @param parent The parent object.
+     *
+     * @since 5.3
+     */
+    explicit ContactGroupExpandJob(const Akonadi::Item &group, QObject *parent = Q_NULLPTR);
+
     /**
      * Destroys the contact group expand job.
      */
@@ -20,6 +20,8 @@
 */
 
 #include "contactgroupmodel_p.h"
+#include "contactgroupexpandcache_p.h"
+#include "contactparts.h"
 
 #include <itemfetchjob.h>
 #include <itemfetchscope.h>
@@ -35,6 +37,7 @@ using namespace Akonadi;
 struct GroupMember {
     GroupMember()
         : isReference(false)
+        , isResolved(false)
         , loadingError(false)
     {
     }
@@ -43,9 +46,19 @@ struct GroupMember {
     KContacts::ContactGroup::Data data;
     KContacts::Addressee referencedContact;
     bool isReference;
+    bool isResolved;
     bool loadingError;
 };
 
+// the members only hold implicitly shared data
+Q_DECLARE_TYPEINFO(GroupMember, Q_MOVABLE_TYPE);
+
+// The references a fetch job was started for
+struct FetchRequest {
+    QSet<Item::Id> ids;
+    QSet<QString> gids;
+};
+
 class Q_DECL_HIDDEN ContactGroupModel::Private
 {
 public:
@@ -54,104 +67,230 @@ public:
     {
     }
 
-    void resolveContactReference(const KContacts::ContactGroup::ContactReference &reference, int row)
+    /**
+     * Resolves the contacts of all reference members that are neither
+     * resolved nor being fetched yet, from the shared cache where possible
+     * and with one fetch for ids and one for gids otherwise.
+     */
+    void resolveContactReferences()
+    {
+        ContactGroupExpandCache *cache = ContactGroupExpandCache::instance();
+
+        FetchRequest requestById;
+        FetchRequest requestByGid;
+        Item::List itemsById;
+        Item::List itemsByGid;
+        int firstRow = -1;
+        int lastRow = -1;
+
+        for (int row = 0; row < mMembers.count(); ++row) {
+            GroupMember &member = mMembers[row];
+            if (!member.isReference || member.isResolved || member.loadingError) {
+                continue;
+            }
+
+            const QString gid = member.reference.gid();
+            const Item::Id id = gid.isEmpty() ? member.reference.uid().toLongLong() : -1;
+            if (gid.isEmpty() ? mPendingIds.contains(id) : mPendingGids.contains(gid)) {
+                continue;
+            }
+
+            Item item;
+            if (cache->lookupContact(id, gid, &item)) {
+                member.referencedContact = item.payload<KContacts::Addressee>();
+                member.isResolved = true;
+                if (firstRow == -1) {
+                    firstRow = row;
+                }
+                lastRow = row;
+            } else if (!gid.isEmpty()) {
+                if (!requestByGid.gids.contains(gid)) {
+                    requestByGid.gids.insert(gid);
+                    item.setGid(gid);
+                    itemsByGid.append(item);
+                }
+            } else if (!requestById.ids.contains(id)) {
+                requestById.ids.insert(id);
+                item.setId(id);
+                itemsById.append(item);
+            }
+        }
+
+        if (firstRow != -1) {
+            Q_EMIT mParent->dataChanged(mParent->index(firstRow, 0, QModelIndex()), mParent->index(lastRow, 1, QModelIndex()));
+        }
+
+        if (!itemsById.isEmpty()) {
+            fetchContacts(itemsById, requestById, false);
+        }
+        if (!itemsByGid.isEmpty()) {
+            fetchContacts(itemsByGid, requestByGid, false);
+        }
+    }
+
+    void fetchContacts(const Item::List &items, const FetchRequest &request, bool fullPayload)
     {
-        Item item;
-        if (!reference.gid().isEmpty()) {
-            item.setGid(reference.gid());
+        ItemFetchJob *job = new ItemFetchJob(items, mParent);
+        // name and email addresses are all we show, unless the contact
+        // does not provide the lookup part
+        if (fullPayload) {
+            job->fetchScope().fetchFullPayload();
         } else {
-            item.setId(reference.uid().toLongLong());
+            job->fetchScope().fetchPayloadPart(ContactPart::Lookup);
         }
-        ItemFetchJob *job = new ItemFetchJob(item, mParent);
-        job->setProperty("row", row);
-        job->fetchScope().fetchFullPayload();
+        job->fetchScope().setFetchGid(true);
+        job->fetchScope().setIgnoreRetrievalErrors(true);
+        job->setProperty("fullPayload", fullPayload);
+
+        mFetchRequests.insert(job, request);
+        mPendingIds += request.ids;
+        mPendingGids += request.gids;
 
         mParent->connect(job, SIGNAL(result(KJob*)), SLOT(itemFetched(KJob*)));
     }
 
     void itemFetched(KJob *job)
     {
-        const int row = job->property("row").toInt();
+        const FetchRequest request = mFetchRequests.take(job);
+        mPendingIds -= request.ids;
+        mPendingGids -= request.gids;
 
-        if (job->error()) {
-            mMembers[row].loadingError = true;
-            Q_EMIT mParent->dataChanged(mParent->index(row, 0, QModelIndex()), mParent->index(row, 1, QModelIndex()));
-            return;
+        ItemFetchJob *fetchJob = qobject_cast<ItemFetchJob *>(job);
+        const bool fullPayload = job->property("fullPayload").toBool();
+
+        // the job fails if none of the requested contacts exist anymore
+        QHash<Item::Id, KContacts::Addressee> contacts;
+        QHash<QString, Item::Id> gids;
+        Item::List incompleteItems;
+        FetchRequest incompleteRequest;
+        if (!job->error()) {
+            foreach (const Item &item, fetchJob->items()) {
+                if (!item.gid().isEmpty()) {
+                    gids.insert(item.gid(), item.id());
+                }
+                if (item.hasPayload<KContacts::Addressee>()) {
+                    ContactGroupExpandCache::instance()->insertContact(item);
+                    contacts.insert(item.id(), item.payload<KContacts::Addressee>());
+                } else if (!fullPayload) {
+                    incompleteItems.append(Item(item.id()));
+                    incompleteRequest.ids.insert(item.id());
+                    if (!item.gid().isEmpty() && request.gids.contains(item.gid())) {
+                        incompleteRequest.gids.insert(item.gid());
+                    }
+                }
+            }
         }
 
-        ItemFetchJob *fetchJob = qobject_cast<ItemFetchJob *>(job);
+        int firstRow = -1;
+        int lastRow = -1;
+        for (int row = 0; row < mMembers.count(); ++row) {
+            GroupMember &member = mMembers[row];
+            if (!member.isReference || member.isResolved || member.loadingError) {
+                continue;
+            }
 
-        if (fetchJob->items().count() != 1) {
-            mMembers[row].loadingError = true;
-            Q_EMIT mParent->dataChanged(mParent->index(row, 0, QModelIndex()), mParent->index(row, 1, QModelIndex()));
-            return;
+            // the reference might have been changed while the job was running
+            const QString gid = member.reference.gid();
+            Item::Id id = -1;
+            if (!gid.isEmpty()) {
+                if (!request.gids.contains(gid)) {
+                    continue;
+                }
+                id = gids.value(gid, -1);
+            } else {
+                id = member.reference.uid().toLongLong();
+                if (!request.ids.contains(id)) {
+                    continue;
+                }
+            }
+
+            if (contacts.contains(id)) {
+                member.referencedContact = contacts.value(id);
+                member.isResolved = true;
+            } else if (incompleteRequest.ids.contains(id)) {
+                continue;
+            } else {
+                member.loadingError = true;
+            }
+
+            if (firstRow == -1) {
+                firstRow = row;
+            }
+            lastRow = row;
+        }
+
+        if (firstRow != -1) {
+            Q_EMIT mParent->dataChanged(mParent->index(firstRow, 0, QModelIndex()), mParent->index(lastRow, 1, QModelIndex()));
         }
 
-        const Item item = fetchJob->items().at(0);
-        const KContacts::Addressee contact = item.payload<KContacts::Addressee>();
+        if (!incompleteItems.isEmpty()) {
+            fetchContacts(incompleteItems, incompleteRequest, true);
+        }
+    }
 
-        GroupMember &member = mMembers[row];
-        member.referencedContact = contact;
-        Q_EMIT mParent->dataChanged(mParent->index(row, 0, QModelIndex()), mParent->index(row, 1, QModelIndex()));
+    static bool isEmptyData(const GroupMember &member)
+    {
+        return !member.isReference && member.data.name().isEmpty() && member.data.email().isEmpty();
     }
 
-    void normalizeMemberList()
+    /**
+     * Ensures that the member list ends with exactly one empty row, used for
+     * adding new members, and contains no other empty rows.
+     *
+     * @param notify Whether to emit the row insertion and removal signals.
+     */
+    void normalizeMemberList(bool notify = true)
     {
-        // check whether a normalization is needed or not
-        bool needsNormalization = false;
-        if (mMembers.isEmpty()) {
-            needsNormalization = true;
-        } else {
-            for (int i = 0; i < mMembers.count(); ++i) {
-                const GroupMember &member = mMembers[i];
-                if (!member.isReference && !(i == mMembers.count() - 1)) {
-                    if (member.data.name().isEmpty() && member.data.email().isEmpty()) {
-                        needsNormalization = true;
-                        break;
-                    }
+        // find the runs of empty rows, except the last row
+        QVector<QPair<int, int> > emptyRanges;
+        for (int i = 0; i < mMembers.count() - 1; ++i) {
+            if (isEmptyData(mMembers.at(i))) {
+                if (!emptyRanges.isEmpty() && emptyRanges.last().second == i - 1) {
+                    emptyRanges.last().second = i;
+                } else {
+                    emptyRanges.append(qMakePair(i, i));
                 }
             }
-
-            const GroupMember &member = mMembers.last();
-            if (member.isReference || !(member.data.name().isEmpty() && member.data.email().isEmpty())) {
-                needsNormalization = true;
-            }
         }
 
-        // if not, avoid to update the model and view
-        if (!needsNormalization) {
+        const bool needsEmptyRow = mMembers.isEmpty() || !isEmptyData(mMembers.last());
+
+        // if nothing is to be done, avoid to update the model and view
+        if (emptyRanges.isEmpty() && !needsEmptyRow) {
             return;
         }
 
-        bool foundEmpty = false;
-
         // add an empty line at the end
-        mParent->beginInsertRows(QModelIndex(), mMembers.count(), mMembers.count());
-        GroupMember member;
-        member.isReference = false;
-        mMembers.append(member);
-        mParent->endInsertRows();
-
-        // remove all empty lines first except the last line
-        do {
-            foundEmpty = false;
-            for (int i = 0; i < mMembers.count(); ++i) {
-                const GroupMember &member = mMembers[i];
-                if (!member.isReference && !(i == mMembers.count() - 1)) {
-                    if (member.data.name().isEmpty() && member.data.email().isEmpty()) {
-                        mParent->beginRemoveRows(QModelIndex(), i, i);
-                        mMembers.remove(i);
-                        mParent->endRemoveRows();
-                        foundEmpty = true;
-                        break;
-                    }
-                }
+        if (needsEmptyRow) {
+            if (notify) {
+                mParent->beginInsertRows(QModelIndex(), mMembers.count(), mMembers.count());
             }
-        } while (foundEmpty);
+            mMembers.append(GroupMember());
+            if (notify) {
+                mParent->endInsertRows();
+            }
+        }
+
+        // remove the empty ranges from the back, so that the rows of the
+        // remaining ranges stay valid
+        for (int i = emptyRanges.count() - 1; i >= 0; --i) {
+            const int first = emptyRanges.at(i).first;
+            const int last = emptyRanges.at(i).second;
+            if (notify) {
+                mParent->beginRemoveRows(QModelIndex(), first, last);
+            }
+            mMembers.erase(mMembers.begin() + first, mMembers.begin() + last + 1);
+            if (notify) {
+                mParent->endRemoveRows();
+            }
+        }
     }
 
     ContactGroupModel *mParent;
     QVector<GroupMember> mMembers;
+    QHash<KJob *, FetchRequest> mFetchRequests;
+    QSet<Item::Id> mPendingIds;
+    QSet<QString> mPendingGids;
     KContacts::ContactGroup mGroup;
     QString mLastErrorMessage;
 };
@@ -169,7 +308,7 @@ ContactGroupModel::~ContactGroupModel()
 
 void ContactGroupModel::loadContactGroup(const KContacts::ContactGroup &contactGroup)
 {
-    Q_EMIT layoutAboutToBeChanged();
+    beginResetModel();
 
     d->mMembers.clear();
     d->mGroup = contactGroup;
@@ -190,13 +329,13 @@ void ContactGroupModel::loadContactGroup(const KContacts::ContactGroup &contactG
         member.reference = reference;
 
         d->mMembers.append(member);
-
-        d->resolveContactReference(reference, d->mMembers.count() - 1);
     }
 
-    d->normalizeMemberList();
+    d->normalizeMemberList(false);
+
+    endResetModel();
 
-    Q_EMIT layoutChanged();
+    d->resolveContactReferences();
 }
 
 bool ContactGroupModel::storeContactGroup(KContacts::ContactGroup &group) const
@@ -360,7 +499,9 @@ bool ContactGroupModel::setData(const QModelIndex &index, const QVariant &value,
         if (member.isReference) {
             if (index.column() == 0) {
                 member.reference.setUid(QString::number(value.toLongLong()));
-                d->resolveContactReference(member.reference, index.row());
+                member.isResolved = false;
+                member.loadingError = false;
+                d->resolveContactReferences();
             }
             if (index.column() == 1) {
                 const QString email = value.toString();
@@ -459,9 +600,7 @@ bool ContactGroupModel::removeRows(int row, int count, const QModelIndex &parent
     }
 
     beginRemoveRows(QModelIndex(), row, row + count - 1);
-    for (int i = 0; i < count; ++i) {
-        d->mMembers.remove(row);
-    }
+    d->mMembers.remove(row, count);
     endRemoveRows();
 
     return true;
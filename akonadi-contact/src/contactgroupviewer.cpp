@@ -207,7 +207,7 @@ void ContactGroupViewer::itemChanged(const Item &item)
         d->mExpandJob->kill();
     }
 
-    d->mExpandJob = new ContactGroupExpandJob(group);
+    d->mExpandJob = new ContactGroupExpandJob(item);
     connect(d->mExpandJob, SIGNAL(result(KJob*)), SLOT(_k_expandResult(KJob*)));
     d->mExpandJob->start();
 }
@@ -0,0 +1,402 @@
+/*
+    This file is part of Akonadi Contact.
+
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "contactsearchindex.h"
+#include "contactsearchindex_p.h"
+#include "akonadi_contact_debug.h"
+#include "contactparts.h"
+
+#include <collectionfetchjob.h>
+#include <collectionfetchscope.h>
+#include <itemfetchjob.h>
+#include <itemfetchscope.h>
+#include <monitor.h>
+
+#include <kcontacts/addressee.h>
+
+#include <QtCore/QRegExp>
+#include <QtCore/QSet>
+
+using namespace Akonadi;
+
+class Q_DECL_HIDDEN ContactSearchIndex::Private
+{
+public:
+    Private(ContactSearchIndex *parent)
+        : mParent(parent)
+        , mRunningFetches(0)
+        , mLoaded(false)
+    {
+    }
+
+    void fetchItems(const Collection &collection, const Item::List &items, bool fullPayload)
+    {
+        ItemFetchJob *job = collection.isValid() ? new ItemFetchJob(collection, mParent)
+                            : new ItemFetchJob(items, mParent);
+        // the standard part contains everything but photos, logos and sounds
+        if (fullPayload) {
+            job->fetchScope().fetchFullPayload();
+        } else {
+            job->fetchScope().fetchPayloadPart(ContactPart::Standard);
+        }
+        job->fetchScope().setAncestorRetrieval(ItemFetchScope::Parent);
+        job->fetchScope().setIgnoreRetrievalErrors(true);
+        job->setProperty("fullPayload", fullPayload);
+
+        mParent->connect(job, SIGNAL(result(KJob*)), SLOT(itemsFetched(KJob*)));
+
+        mRunningFetches++;
+    }
+
+    void collectionsFetched(KJob *job)
+    {
+        if (job->error()) {
+            qCWarning(AKONADICONTACT_LOG) << "Unable to list address books:" << job->errorText();
+        } else {
+            foreach (const Collection &collection, qobject_cast<CollectionFetchJob *>(job)->collections()) {
+                if (collection.contentMimeTypes().contains(KContacts::Addressee::mimeType())) {
+                    fetchItems(collection, Item::List(), false);
+                }
+            }
+        }
+
+        if (mRunningFetches == 0) {
+            setLoaded();
+        }
+    }
+
+    void itemsFetched(KJob *job)
+    {
+        mRunningFetches--;
+
+        if (job->error()) {
+            qCWarning(AKONADICONTACT_LOG) << "Unable to load contacts:" << job->errorText();
+        }
+
+        const bool fullPayload = job->property("fullPayload").toBool();
+        Item::List incompleteItems;
+        foreach (const Item &item, qobject_cast<ItemFetchJob *>(job)->items()) {
+            if (item.hasPayload<KContacts::Addressee>()) {
+                // do not overwrite newer data received from the monitor, nor
+                // add back contacts removed while they were fetched
+                if (mWords.revision(item.id()) <= item.revision()
+                        && !mRemovedItems.contains(item.id())
+                        && !mRemovedCollections.contains(item.parentCollection().id())) {
+                    mWords.insert(item);
+                }
+            } else if (!fullPayload) {
+                incompleteItems.append(Item(item.id()));
+            }
+        }
+
+        if (!incompleteItems.isEmpty()) {
+            fetchItems(Collection(), incompleteItems, true);
+        }
+
+        if (mRunningFetches == 0) {
+            mRemovedItems.clear();
+            mRemovedCollections.clear();
+            if (!mLoaded) {
+                setLoaded();
+            }
+        }
+    }
+
+    void setLoaded()
+    {
+        mLoaded = true;
+        mRemovedItems.clear();
+        mRemovedCollections.clear();
+        Q_EMIT mParent->loaded();
+    }
+
+    void itemChanged(const Item &item)
+    {
+        if (item.hasPayload<KContacts::Addressee>()) {
+            mWords.insert(item);
+        } else {
+            fetchItems(Collection(), Item::List() << Item(item.id()), true);
+        }
+    }
+
+    void itemRemoved(const Item &item)
+    {
+        mWords.remove(item.id());
+        if (mRunningFetches > 0) {
+            mRemovedItems.insert(item.id());
+        }
+    }
+
+    void itemMoved(const Item &item, const Collection &, const Collection &destination)
+    {
+        mWords.setParentCollection(item.id(), destination);
+    }
+
+    void collectionRemoved(const Collection &collection)
+    {
+        mWords.removeCollection(collection);
+        if (mRunningFetches > 0) {
+            mRemovedCollections.insert(collection.id());
+        }
+    }
+
+    ContactSearchIndex *mParent;
+    Monitor *mMonitor;
+    ContactWordIndex mWords;
+    // removed while fetches were running, cleared once all have finished
+    QSet<Item::Id> mRemovedItems;
+    QSet<Collection::Id> mRemovedCollections;
+    int mRunningFetches;
+    bool mLoaded;
+};
+
+ContactSearchIndex::ContactSearchIndex(QObject *parent)
+    : QObject(parent)
+    , d(new Private(this))
+{
+    d->mMonitor = new Monitor(this);
+    d->mMonitor->setMimeTypeMonitored(KContacts::Addressee::mimeType());
+    d->mMonitor->itemFetchScope().fetchPayloadPart(ContactPart::Standard);
+    d->mMonitor->itemFetchScope().setAncestorRetrieval(ItemFetchScope::Parent);
+
+    connect(d->mMonitor, SIGNAL(itemAdded(Akonadi::Item,Akonadi::Collection)),
+            this, SLOT(itemChanged(Akonadi::Item)));
+    connect(d->mMonitor, SIGNAL(itemChanged(Akonadi::Item,QSet<QByteArray>)),
+            this, SLOT(itemChanged(Akonadi::Item)));
+    connect(d->mMonitor, SIGNAL(itemRemoved(Akonadi::Item)),
+            this, SLOT(itemRemoved(Akonadi::Item)));
+    connect(d->mMonitor, SIGNAL(itemMoved(Akonadi::Item,Akonadi::Collection,Akonadi::Collection)),
+            this, SLOT(itemMoved(Akonadi::Item,Akonadi::Collection,Akonadi::Collection)));
+    connect(d->mMonitor, SIGNAL(collectionRemoved(Akonadi::Collection)),
+            this, SLOT(collectionRemoved(Akonadi::Collection)));
+
+    CollectionFetchJob *job = new CollectionFetchJob(Collection::root(), CollectionFetchJob::Recursive, this);
+    job->fetchScope().setContentMimeTypes(QStringList() << KContacts::Addressee::mimeType());
+    connect(job, SIGNAL(result(KJob*)), this, SLOT(collectionsFetched(KJob*)));
+}
+
+ContactSearchIndex::~ContactSearchIndex()
+{
+    delete d;
+}
+
+bool ContactSearchIndex::isLoaded() const
+{
+    return d->mLoaded;
+}
+
+int ContactSearchIndex::count() const
+{
+    return d->mWords.count();
+}
+
+Item::List ContactSearchIndex::items() const
+{
+    return d->mWords.items();
+}
+
+Item::List ContactSearchIndex::search(const QString &text, int limit) const
+{
+    return d->mWords.search(text, limit);
+}
+
+static QString fold(const QString &text)
+{
+    return text.toCaseFolded();
+}
+
+static void addKeys(const QString &text, QSet<QString> &keys)
+{
+    const QString folded = fold(text);
+    if (folded.isEmpty()) {
+        return;
+    }
+
+    keys.insert(folded);
+    foreach (const QString &word, ContactWordIndex::words(folded)) {
+        keys.insert(word);
+    }
+}
+
+void ContactWordIndex::insert(const Item &item)
+{
+    remove(item.id());
+
+    // only keep what a lookup needs
+    KContacts::Addressee contact = item.payload<KContacts::Addressee>();
+    contact.setPhoto(KContacts::Picture());
+    contact.setLogo(KContacts::Picture());
+    contact.setSound(KContacts::Sound());
+
+    Entry entry;
+    entry.item = Item(item.id());
+    entry.item.setRevision(item.revision());
+    entry.item.setGid(item.gid());
+    entry.item.setMimeType(item.mimeType());
+    entry.item.setParentCollection(item.parentCollection());
+    entry.item.setPayload<KContacts::Addressee>(contact);
+
+    QSet<QString> keys;
+    addKeys(contact.formattedName(), keys);
+    addKeys(contact.realName(), keys);
+    addKeys(contact.givenName(), keys);
+    addKeys(contact.familyName(), keys);
+    addKeys(contact.nickName(), keys);
+    foreach (const QString &email, contact.emails()) {
+        addKeys(email, keys);
+    }
+    entry.keys = keys.toList();
+
+    foreach (const QString &key, entry.keys) {
+        mKeys.insert(key, item.id());
+    }
+    mEntries.insert(item.id(), entry);
+}
+
+void ContactWordIndex::remove(Item::Id id)
+{
+    const QHash<Item::Id, Entry>::iterator it = mEntries.find(id);
+    if (it == mEntries.end()) {
+        return;
+    }
+
+    foreach (const QString &key, it->keys) {
+        mKeys.remove(key, id);
+    }
+    mEntries.erase(it);
+}
+
+void ContactWordIndex::removeCollection(const Collection &collection)
+{
+    QList<Item::Id> ids;
+    for (QHash<Item::Id, Entry>::const_iterator it = mEntries.constBegin(); it != mEntries.constEnd(); ++it) {
+        if (it->item.parentCollection().id() == collection.id()) {
+            ids.append(it.key());
+        }
+    }
+
+    foreach (Item::Id id, ids) {
+        remove(id);
+    }
+}
+
+int ContactWordIndex::revision(Item::Id id) const
+{
+    const QHash<Item::Id, Entry>::const_iterator it = mEntries.constFind(id);
+    return it == mEntries.constEnd() ? -1 : it->item.revision();
+}
+
+void ContactWordIndex::setParentCollection(Item::Id id, const Collection &collection)
+{
+    const QHash<Item::Id, Entry>::iterator it = mEntries.find(id);
+    if (it != mEntries.end()) {
+        it->item.setParentCollection(collection);
+    }
+}
+
+int ContactWordIndex::count() const
+{
+    return mEntries.count();
+}
+
+Item::List ContactWordIndex::items() const
+{
+    Item::List items;
+    items.reserve(mEntries.count());
+    for (QHash<Item::Id, Entry>::const_iterator it = mEntries.constBegin(); it != mEntries.constEnd(); ++it) {
+        items.append(it->item);
+    }
+
+    return items;
+}
+
+Item::List ContactWordIndex::search(const QString &text, int limit) const
+{
+    Item::List items;
+
+    QStringList terms = fold(text).split(QRegExp(QStringLiteral("\\s+")), QString::SkipEmptyParts);
+    if (terms.isEmpty()) {
+        return items;
+    }
+
+    // walk the keys of the longest, most selective term, and check
+    // the other terms against the keys of each candidate
+    int longest = 0;
+    for (int i = 1; i < terms.count(); ++i) {
+        if (terms.at(i).size() > terms.at(longest).size()) {
+            longest = i;
+        }
+    }
+    const QString first = terms.takeAt(longest);
+
+    QSet<Item::Id> seen;
+    for (QMultiMap<QString, Item::Id>::const_iterator it = mKeys.lowerBound(first);
+            it != mKeys.constEnd() && it.key().startsWith(first); ++it) {
+        if (seen.contains(it.value())) {
+            continue;
+        }
+        seen.insert(it.value());
+
+        const Entry &entry = *mEntries.constFind(it.value());
+        bool matches = true;
+        foreach (const QString &term, terms) {
+            bool found = false;
+            foreach (const QString &key, entry.keys) {
+                if (key.startsWith(term)) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                matches = false;
+                break;
+            }
+        }
+
+        if (matches) {
+            items.append(entry.item);
+            if (limit >= 0 && items.count() >= limit) {
+                break;
+            }
+        }
+    }
+
+    return items;
+}
+
+QStringList ContactWordIndex::words(const QString &text)
+{
+    const QString folded = fold(text);
+
+    QStringList words;
+    int start = -1;
+    for (int i = 0; i <= folded.size(); ++i) {
+        const bool isWordChar = i < folded.size() && folded.at(i).isLetterOrNumber();
+        if (isWordChar && start == -1) {
+            start = i;
+        } else if (!isWordChar && start != -1) {
+            words.append(folded.mid(start, i - start));
+            start = -1;
+        }
+    }
+
+    return words;
+}
+
+#include "moc_contactsearchindex.cpp"
@@ -0,0 +1,124 @@
+/*
+    This file is part of Akonadi Contact.
+
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef AKONADI_CONTACTSEARCHINDEX_H
+#define AKONADI_CONTACTSEARCHINDEX_H
+
+#include "akonadi-contact_export.h"
+
+#include <item.h>
+
+#include <QtCore/QObject>
+
+class KJob;
+
+namespace Akonadi
+{
+
+/**
+ * @short An in-memory index of all contacts for fast lookups.
+ *
+ * This class loads the contacts of all address books into memory, without
+ * photos, logos and sounds, and indexes the words of their names, nicknames
+ * and email addresses by prefix. A Monitor keeps the index up to date.
+ *
+ * Searching the index does not involve the Akonadi server or its search
+ * backend, which makes it suitable for address completion while typing.
+ * The index can also be used by a ContactSearchJob, see
+ * ContactSearchJob::setSearchIndex().
+ *
+ * @code
+ *
+ * Akonadi::ContactSearchIndex *index = new Akonadi::ContactSearchIndex( this );
+ *
+ * ...
+ *
+ * const Akonadi::Item::List items = index->search( "tob", 10 );
+ *
+ * @endcode
+ *
+ * @since 5.3
+ */
+class AKONADI_CONTACT_EXPORT ContactSearchIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Creates a new contact search index and starts loading the contacts.
+     *
+     * @param parent The parent object.
+     */
+    explicit ContactSearchIndex(QObject *parent = Q_NULLPTR);
+
+    /**
+     * Destroys the contact search index.
+     */
+    ~ContactSearchIndex();
+
+    /**
+     * Returns whether all contacts have been loaded.
+     */
+    bool isLoaded() const;
+
+    /**
+     * Returns the number of indexed contacts.
+     */
+    int count() const;
+
+    /**
+     * Returns the items of all indexed contacts, with a
+     * KContacts::Addressee payload.
+     */
+    Akonadi::Item::List items() const;
+
+    /**
+     * Returns the items of the contacts for which every whitespace separated
+     * term of @p text is the prefix of a word of their name, nickname or email
+     * addresses, or of one of these as a whole. The comparison is case
+     * insensitive.
+     *
+     * @param text The text to search for.
+     * @param limit The maximum number of returned items, or -1 for no limit.
+     */
+    Akonadi::Item::List search(const QString &text, int limit = -1) const;
+
+Q_SIGNALS:
+    /**
+     * This signal is emitted when all contacts have been loaded.
+     */
+    void loaded();
+
+private:
+    //@cond PRIVATE
+    class Private;
+    Private *const d;
+
+    Q_PRIVATE_SLOT(d, void collectionsFetched(KJob *))
+    Q_PRIVATE_SLOT(d, void itemsFetched(KJob *))
+    Q_PRIVATE_SLOT(d, void itemChanged(const Akonadi::Item &))
+    Q_PRIVATE_SLOT(d, void itemRemoved(const Akonadi::Item &))
+    Q_PRIVATE_SLOT(d, void itemMoved(const Akonadi::Item &, const Akonadi::Collection &, const Akonadi::Collection &))
+    Q_PRIVATE_SLOT(d, void collectionRemoved(const Akonadi::Collection &))
+    //@endcond
+};
+
+}
+
+#endif
@@ -0,0 +1,104 @@
+/*
+    This file is part of Akonadi Contact.
+
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef AKONADI_CONTACTSEARCHINDEX_P_H
+#define AKONADI_CONTACTSEARCHINDEX_P_H
+
+#include "akonadi-contactprivate_export.h"
+
+#include <collection.h>
+#include <item.h>
+
+#include <QtCore/QHash>
+#include <QtCore/QMultiMap>
+#include <QtCore/QStringList>
+
+namespace Akonadi
+{
+
+/**
+ * @internal
+ *
+ * The words of the contacts indexed by ContactSearchIndex, without the
+ * loading and monitoring of the contacts.
+ */
+class AKONADI_CONTACT_TEST_EXPORT ContactWordIndex
+{
+public:
+    /**
+     * Adds the contact of @p item, which must have a KContacts::Addressee
+     * payload, replacing an older version of it.
+     */
+    void insert(const Akonadi::Item &item);
+
+    /**
+     * Removes the contact with the item @p id.
+     */
+    void remove(Akonadi::Item::Id id);
+
+    /**
+     * Removes all contacts of the @p collection.
+     */
+    void removeCollection(const Akonadi::Collection &collection);
+
+    /**
+     * Returns the revision of the indexed item @p id, or -1 if it is not indexed.
+     */
+    int revision(Akonadi::Item::Id id) const;
+
+    /**
+     * Sets the parent collection of the indexed item @p id.
+     */
+    void setParentCollection(Akonadi::Item::Id id, const Akonadi::Collection &collection);
+
+    /**
+     * Returns the number of indexed contacts.
+     */
+    int count() const;
+
+    /**
+     * @see ContactSearchIndex::items()
+     */
+    Akonadi::Item::List items() const;
+
+    /**
+     * @see ContactSearchIndex::search()
+     */
+    Akonadi::Item::List search(const QString &text, int limit = -1) const;
+
+    /**
+     * Returns the case folded words of @p text, the runs of letters and
+     * numbers, as they are indexed.
+     */
+    static QStringList words(const QString &text);
+
+private:
+    struct Entry {
+        Akonadi::Item item;
+        QStringList keys;
+    };
+
+    QHash<Akonadi::Item::Id, Entry> mEntries;
+    // folded words and full values, mapping to the item ids
+    QMultiMap<QString, Akonadi::Item::Id> mKeys;
+};
+
+}
+
+#endif
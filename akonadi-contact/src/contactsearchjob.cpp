@@ -20,24 +20,56 @@
 */
 
 #include "contactsearchjob.h"
+#include "contactsearchjob_p.h"
+#include "contactparts.h"
+#include "contactsearchindex.h"
+#include "contactsearchindex_p.h"
 #include <searchquery.h>
 
 #include <itemfetchscope.h>
 
+#include <QtCore/QPointer>
+
+#include <climits>
+
 using namespace Akonadi;
 
+// How many more contacts than the limit the storage may return when the
+// results are filtered, so that the limit can still be reached after
+// dropping the contacts that do not match
+static const int s_overFetchFactor = 10;
+
 class Q_DECL_HIDDEN ContactSearchJob::Private
 {
 public:
+    Private(ContactSearchJob *parent)
+        : mParent(parent)
+        , mContactCount(0)
+        , mLimit(-1)
+        , mFetchProfile(FullProfile)
+    {
+    }
+
+    Akonadi::SearchQuery searchQuery() const;
+    void updateFetchScope();
+    void itemsReceived(const Akonadi::Item::List &items);
+    void addContacts(const Akonadi::Item::List &items, bool filter);
+    Akonadi::Item::List indexCandidates() const;
+
+    ContactSearchJob *mParent;
+    KContacts::Addressee::List mContacts;
+    int mContactCount;
+    ContactSearchCriteria mCriteria;
     int mLimit;
+    FetchProfile mFetchProfile;
+    QPointer<ContactSearchIndex> mIndex;
 };
 
 ContactSearchJob::ContactSearchJob(QObject *parent)
     : ItemSearchJob(parent)
-    , d(new Private())
+    , d(new Private(this))
 {
     fetchScope().fetchFullPayload();
-    d->mLimit = -1;
 
     setMimeTypes(QStringList() << KContacts::Addressee::mimeType());
 
@@ -45,6 +77,8 @@ ContactSearchJob::ContactSearchJob(QObject *parent)
     Akonadi::SearchQuery query;
     query.addTerm(ContactSearchTerm(ContactSearchTerm::All, QVariant(), SearchTerm::CondEqual));
     ItemSearchJob::setQuery(query);
+
+    connect(this, SIGNAL(itemsReceived(Akonadi::Item::List)), this, SLOT(itemsReceived(Akonadi::Item::List)));
 }
 
 ContactSearchJob::~ContactSearchJob()
@@ -60,47 +94,360 @@ static Akonadi::SearchTerm::Condition matchType(ContactSearchJob::Match match)
     case ContactSearchJob::StartsWithMatch:
     case ContactSearchJob::ContainsWordBoundaryMatch:
     case ContactSearchJob::ContainsMatch:
+        // the storage has no prefix matching, the results are filtered
+        // in Private::addContacts()
         return Akonadi::SearchTerm::CondContains;
     }
     return Akonadi::SearchTerm::CondEqual;
 }
 
-void ContactSearchJob::setQuery(Criterion criterion, const QString &value, Match match)
+// Returns whether the storage can search for the criterion
+static bool isSearchable(ContactSearchJob::Criterion criterion)
 {
-    Akonadi::SearchQuery query(SearchTerm::RelOr);
+    switch (criterion) {
+    case ContactSearchJob::PhoneNumber:
+    case ContactSearchJob::Organization:
+    case ContactSearchJob::Category:
+        return false;
+    default:
+        return true;
+    }
+}
 
-    if (criterion == Name) {
-        query.addTerm(ContactSearchTerm(ContactSearchTerm::Name, value, matchType(match)));
-    } else if (criterion == Email) {
-        query.addTerm(ContactSearchTerm(ContactSearchTerm::Email, value, matchType(match)));
-    } else if (criterion == NickName) {
-        query.addTerm(ContactSearchTerm(ContactSearchTerm::Nickname, value, matchType(match)));
-    } else if (criterion == NameOrEmail) {
-        query.addTerm(ContactSearchTerm(ContactSearchTerm::Name, value, matchType(match)));
-        query.addTerm(ContactSearchTerm(ContactSearchTerm::Email, value, matchType(match)));
-    } else if (criterion == ContactUid) {
-        query.addTerm(ContactSearchTerm(ContactSearchTerm::Uid, value, matchType(match)));
+static QString normalizedPhoneNumber(const QString &number)
+{
+    QString result;
+    result.reserve(number.size());
+    foreach (const QChar &c, number) {
+        if (c.isDigit() || (c == QLatin1Char('+') && result.isEmpty())) {
+            result.append(c);
+        }
     }
+    return result;
+}
 
-    query.setLimit(d->mLimit);
+static QStringList criterionValues(const KContacts::Addressee &contact, ContactSearchJob::Criterion criterion)
+{
+    QStringList values;
 
-    ItemSearchJob::setQuery(query);
+    switch (criterion) {
+    case ContactSearchJob::Name:
+        values << contact.realName() << contact.formattedName() << contact.givenName() << contact.familyName();
+        break;
+    case ContactSearchJob::Email:
+        values = contact.emails();
+        break;
+    case ContactSearchJob::NickName:
+        values << contact.nickName();
+        break;
+    case ContactSearchJob::NameOrEmail:
+        values << contact.realName() << contact.formattedName() << contact.givenName() << contact.familyName()
+               << contact.emails();
+        break;
+    case ContactSearchJob::ContactUid:
+        values << contact.uid();
+        break;
+    case ContactSearchJob::PhoneNumber:
+        foreach (const KContacts::PhoneNumber &number, contact.phoneNumbers()) {
+            values << normalizedPhoneNumber(number.number());
+        }
+        break;
+    case ContactSearchJob::Organization:
+        values << contact.organization();
+        break;
+    case ContactSearchJob::Category:
+        values = contact.categories();
+        break;
+    }
+
+    return values;
 }
 
-void ContactSearchJob::setLimit(int limit)
+static bool matchesValue(const QString &candidate, const QString &value, ContactSearchJob::Match match)
 {
-    d->mLimit = limit;
+    switch (match) {
+    case ContactSearchJob::ExactMatch:
+        return candidate == value;
+    case ContactSearchJob::StartsWithMatch:
+        return candidate.startsWith(value, Qt::CaseInsensitive);
+    case ContactSearchJob::ContainsMatch:
+        return candidate.contains(value, Qt::CaseInsensitive);
+    case ContactSearchJob::ContainsWordBoundaryMatch:
+        for (int pos = candidate.indexOf(value, 0, Qt::CaseInsensitive); pos != -1;
+                pos = candidate.indexOf(value, pos + 1, Qt::CaseInsensitive)) {
+            if (pos == 0 || !candidate.at(pos - 1).isLetterOrNumber()) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return false;
 }
 
-KContacts::Addressee::List ContactSearchJob::contacts() const
+Akonadi::SearchQuery ContactSearchJob::Private::searchQuery() const
 {
-    KContacts::Addressee::List contacts;
+    const Relation relation = mCriteria.relation();
+    Akonadi::SearchQuery query(relation == MatchAny ? SearchTerm::RelOr : SearchTerm::RelAnd);
+
+    bool checkAll = false;
+    foreach (const ContactSearchCriteria::Query &q, mCriteria.queries()) {
+        if (!isSearchable(q.criterion)) {
+            if (relation == MatchAny) {
+                // any contact might match, so all of them have to be checked
+                checkAll = true;
+                break;
+            }
+            continue;
+        }
 
-    foreach (const Item &item, items()) {
+        const SearchTerm::Condition condition = matchType(q.match);
+        if (q.criterion == Name) {
+            query.addTerm(ContactSearchTerm(ContactSearchTerm::Name, q.value, condition));
+        } else if (q.criterion == Email) {
+            query.addTerm(ContactSearchTerm(ContactSearchTerm::Email, q.value, condition));
+        } else if (q.criterion == NickName) {
+            query.addTerm(ContactSearchTerm(ContactSearchTerm::Nickname, q.value, condition));
+        } else if (q.criterion == NameOrEmail) {
+            SearchTerm term(SearchTerm::RelOr);
+            term.addSubTerm(ContactSearchTerm(ContactSearchTerm::Name, q.value, condition));
+            term.addSubTerm(ContactSearchTerm(ContactSearchTerm::Email, q.value, condition));
+            query.addTerm(term);
+        } else if (q.criterion == ContactUid) {
+            query.addTerm(ContactSearchTerm(ContactSearchTerm::Uid, q.value, condition));
+        }
+    }
+
+    if (checkAll || query.isNull()) {
+        // every contact has to be checked, bounded only by the limit below
+        query = Akonadi::SearchQuery();
+        query.addTerm(ContactSearchTerm(ContactSearchTerm::All, QVariant(), SearchTerm::CondEqual));
+    }
+
+    // if the storage does not return exactly the matching contacts, let it
+    // return more of them so that enough are left after filtering
+    if (mLimit >= 0 && mCriteria.needsFiltering()) {
+        query.setLimit(mLimit > INT_MAX / s_overFetchFactor ? -1 : mLimit * s_overFetchFactor);
+    } else {
+        query.setLimit(mLimit);
+    }
+
+    return query;
+}
+
+ContactSearchCriteria::ContactSearchCriteria()
+    : mRelation(ContactSearchJob::MatchAll)
+{
+}
+
+void ContactSearchCriteria::clear()
+{
+    mQueries.clear();
+}
+
+void ContactSearchCriteria::addQuery(ContactSearchJob::Criterion criterion, const QString &value, ContactSearchJob::Match match)
+{
+    Query query;
+    query.criterion = criterion;
+    query.value = value;
+    query.match = match;
+    mQueries.append(query);
+}
+
+QVector<ContactSearchCriteria::Query> ContactSearchCriteria::queries() const
+{
+    return mQueries;
+}
+
+void ContactSearchCriteria::setRelation(ContactSearchJob::Relation relation)
+{
+    mRelation = relation;
+}
+
+ContactSearchJob::Relation ContactSearchCriteria::relation() const
+{
+    return mRelation;
+}
+
+bool ContactSearchCriteria::needsFiltering() const
+{
+    foreach (const Query &q, mQueries) {
+        if (!isSearchable(q.criterion) || q.match == ContactSearchJob::StartsWithMatch
+                || q.match == ContactSearchJob::ContainsWordBoundaryMatch) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ContactSearchCriteria::matches(const KContacts::Addressee &contact) const
+{
+    foreach (const Query &q, mQueries) {
+        const QString value = q.criterion == ContactSearchJob::PhoneNumber ? normalizedPhoneNumber(q.value) : q.value;
+
+        bool matched = false;
+        foreach (const QString &candidate, criterionValues(contact, q.criterion)) {
+            if (matchesValue(candidate, value, q.match)) {
+                matched = true;
+                break;
+            }
+        }
+
+        if (matched && mRelation == ContactSearchJob::MatchAny) {
+            return true;
+        } else if (!matched && mRelation == ContactSearchJob::MatchAll) {
+            return false;
+        }
+    }
+
+    return mRelation == ContactSearchJob::MatchAll;
+}
+
+QString ContactSearchCriteria::indexSearchText() const
+{
+    if (mRelation == ContactSearchJob::MatchAll || mQueries.count() == 1) {
+        foreach (const Query &q, mQueries) {
+            if ((q.criterion == ContactSearchJob::Name || q.criterion == ContactSearchJob::NickName
+                    || q.criterion == ContactSearchJob::Email || q.criterion == ContactSearchJob::NameOrEmail)
+                    && q.match != ContactSearchJob::ContainsMatch) {
+                // a match starts at the beginning of a word, so each word of
+                // the value is a prefix of an indexed word of the contact
+                const QStringList words = ContactWordIndex::words(q.value);
+                if (!words.isEmpty()) {
+                    return words.join(QLatin1Char(' '));
+                }
+            }
+        }
+    }
+
+    return QString();
+}
+
+void ContactSearchJob::Private::updateFetchScope()
+{
+    ItemFetchScope &scope = mParent->fetchScope();
+
+    if (mFetchProfile == FullProfile) {
+        scope.fetchFullPayload();
+        return;
+    }
+
+    scope.fetchFullPayload(false);
+    scope.fetchPayloadPart(ContactPart::Lookup);
+
+    // the lookup part lacks the data to check the other criteria
+    bool needsStandard = false;
+    if (mCriteria.needsFiltering()) {
+        foreach (const ContactSearchCriteria::Query &q, mCriteria.queries()) {
+            if (q.criterion != Name && q.criterion != Email && q.criterion != NameOrEmail && q.criterion != ContactUid) {
+                needsStandard = true;
+                break;
+            }
+        }
+    }
+    scope.fetchPayloadPart(ContactPart::Standard, needsStandard);
+}
+
+void ContactSearchJob::Private::itemsReceived(const Akonadi::Item::List &items)
+{
+    // once enough contacts matched, the rest of the results, bounded by
+    // the over-fetch limit, is received without being matched
+    if (mLimit >= 0 && mContactCount >= mLimit) {
+        return;
+    }
+
+    addContacts(items, mCriteria.needsFiltering());
+}
+
+void ContactSearchJob::Private::addContacts(const Akonadi::Item::List &items, bool filter)
+{
+    KContacts::Addressee::List contacts;
+    foreach (const Item &item, items) {
+        if (mLimit >= 0 && mContactCount >= mLimit) {
+            break;
+        }
         if (item.hasPayload<KContacts::Addressee>()) {
-            contacts.append(item.payload<KContacts::Addressee>());
+            const KContacts::Addressee contact = item.payload<KContacts::Addressee>();
+            if (!filter || mCriteria.matches(contact)) {
+                contacts.append(contact);
+                ++mContactCount;
+            }
         }
     }
 
+    if (!contacts.isEmpty()) {
+        mContacts += contacts;
+        Q_EMIT mParent->contactsReceived(contacts);
+    }
+}
+
+Akonadi::Item::List ContactSearchJob::Private::indexCandidates() const
+{
+    const QString text = mCriteria.indexSearchText();
+    return text.isNull() ? mIndex->items() : mIndex->search(text);
+}
+
+void ContactSearchJob::setQuery(Criterion criterion, const QString &value, Match match)
+{
+    d->mCriteria.clear();
+    addQuery(criterion, value, match);
+}
+
+void ContactSearchJob::addQuery(Criterion criterion, const QString &value, Match match)
+{
+    d->mCriteria.addQuery(criterion, value, match);
+
+    ItemSearchJob::setQuery(d->searchQuery());
+    d->updateFetchScope();
+}
+
+void ContactSearchJob::setQueryRelation(Relation relation)
+{
+    d->mCriteria.setRelation(relation);
+
+    if (!d->mCriteria.queries().isEmpty()) {
+        ItemSearchJob::setQuery(d->searchQuery());
+    }
+}
+
+void ContactSearchJob::setLimit(int limit)
+{
+    d->mLimit = limit;
+}
+
+void ContactSearchJob::setFetchProfile(FetchProfile profile)
+{
+    d->mFetchProfile = profile;
+    d->updateFetchScope();
+}
+
+void ContactSearchJob::setSearchIndex(ContactSearchIndex *index)
+{
+    d->mIndex = index;
+}
+
+void ContactSearchJob::doStart()
+{
+    if (!d->mIndex || !d->mIndex->isLoaded() || !searchCollections().isEmpty()) {
+        ItemSearchJob::doStart();
+        return;
+    }
+
+    // the index has no storage search semantics, so every criterion is
+    // checked on the contacts
+    d->addContacts(d->indexCandidates(), !d->mCriteria.queries().isEmpty());
+    emitResult();
+}
+
+KContacts::Addressee::List ContactSearchJob::contacts() const
+{
+    return d->mContacts;
+}
+
+KContacts::Addressee::List ContactSearchJob::takeContacts()
+{
+    KContacts::Addressee::List contacts;
+    contacts.swap(d->mContacts);
     return contacts;
 }
+
+#include "moc_contactsearchjob.cpp"
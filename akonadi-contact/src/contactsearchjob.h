@@ -30,6 +30,8 @@
 namespace Akonadi
 {
 
+class ContactSearchIndex;
+
 /**
  * @short Job that searches for contacts in the Akonadi storage.
  *
@@ -73,6 +75,29 @@ namespace Akonadi
  *
  * @endcode
  *
+ * @code
+ *
+ * // Search all contacts working at KDE whose name starts with "to"
+ * Akonadi::ContactSearchJob *job = new Akonadi::ContactSearchJob();
+ * job->setQueryRelation( Akonadi::ContactSearchJob::MatchAll );
+ * job->addQuery( Akonadi::ContactSearchJob::Name, "to", Akonadi::ContactSearchJob::StartsWithMatch );
+ * job->addQuery( Akonadi::ContactSearchJob::Organization, "KDE" );
+ *
+ * @endcode
+ *
+ * Criteria the storage cannot search for (phone numbers, organizations and
+ * categories) as well as the StartsWithMatch and ContainsWordBoundaryMatch
+ * match types are evaluated on the contacts returned by the storage, so
+ * contacts() contains exactly the matching contacts while items() may
+ * contain more. In that case the storage is asked for up to ten times the
+ * limit set with setLimit(), so fewer contacts than the limit may be
+ * returned even though more would match.
+ *
+ * If only such unsearchable criteria are given, or if one of them is
+ * combined with MatchAny, the storage cannot narrow down the search at all:
+ * all contacts are fetched and checked, bounded only by the limit. Set a
+ * limit, or a ContactSearchIndex with setSearchIndex(), for such searches.
+ *
  * @author Tobias Koenig <tokoe@kde.org>
  * @since 4.4
  */
@@ -101,7 +126,10 @@ public:
         Email,      ///< The email address of the contact.
         NickName,   ///< The nickname of the contact.
         NameOrEmail, ///< The name or email address of the contact. @since 4.5
-        ContactUid   ///< The global unique identifier of the contact. @since 4.5
+        ContactUid,  ///< The global unique identifier of the contact. @since 4.5
+        PhoneNumber, ///< A phone number of the contact, ignoring formatting characters. @since 5.3
+        Organization, ///< The organization of the contact. @since 5.3
+        Category     ///< A category of the contact. @since 5.3
     };
 
     /**
@@ -125,6 +153,33 @@ public:
      */
     void setQuery(Criterion criterion, const QString &value, Match match = ExactMatch);
 
+    /**
+     * Describes how the criteria added with addQuery() are combined.
+     *
+     * @since 5.3
+     */
+    enum Relation {
+        MatchAll, ///< A contact must match all criteria.
+        MatchAny  ///< A contact must match at least one of the criteria.
+    };
+
+    /**
+     * Adds the @p criterion and @p value with @p match to the criteria of
+     * the search, which are combined as set with setQueryRelation().
+     * @param criterion the query criterion to compare with
+     * @param value the value to match against
+     * @param match how to match the given value
+     * @since 5.3
+     */
+    void addQuery(Criterion criterion, const QString &value, Match match = ExactMatch);
+
+    /**
+     * Sets how multiple criteria are combined. The default is MatchAll.
+     * @param relation the relation between the criteria
+     * @since 5.3
+     */
+    void setQueryRelation(Relation relation);
+
     /**
      * Sets a @p limit on how many results will be returned by this search job.
      *
@@ -137,15 +192,81 @@ public:
      */
     void setLimit(int limit);
 
+    /**
+     * Describes which parts of the contacts are fetched.
+     *
+     * @since 5.3
+     */
+    enum FetchProfile {
+        FullProfile,  ///< The complete contacts, including photos, logos and sounds.
+        LookupProfile ///< Only the names, email addresses and uid of the contacts (see ContactPart::Lookup).
+    };
+
+    /**
+     * Sets which parts of the found contacts are fetched. The default is FullProfile.
+     *
+     * The LookupProfile is much cheaper to transfer and parse, and is all that
+     * is needed for address completion. Data needed to evaluate the search
+     * criteria is fetched in addition.
+     *
+     * @note Contacts whose storage does not provide the lookup part are
+     *       returned by items() without payload, and skipped by contacts().
+     * @param profile the fetch profile to use
+     * @since 5.3
+     */
+    void setFetchProfile(FetchProfile profile);
+
+    /**
+     * Sets a local @p index to search in instead of the Akonadi storage.
+     *
+     * If the index has been loaded when the job starts, and no search
+     * collections have been set, the contacts are searched in the index,
+     * without involving the storage's search backend. items() stays empty
+     * in that case, the results are only available as contacts.
+     * Otherwise the job searches the storage as usual.
+     *
+     * @param index the index to search in, or @c 0 to search the storage
+     * @since 5.3
+     */
+    void setSearchIndex(ContactSearchIndex *index);
+
     /**
      * Returns the contacts that matched the search criteria.
      */
     KContacts::Addressee::List contacts() const;
 
+    /**
+     * Returns the contacts that matched the search criteria, and removes
+     * them from the job. This avoids keeping a second reference to the
+     * contacts, which would make modifying them detach.
+     *
+     * @note items() still holds the payloads of all found items, so the
+     *       contacts are only shared with the job once those are gone.
+     *
+     * @since 5.3
+     */
+    KContacts::Addressee::List takeContacts();
+
+Q_SIGNALS:
+    /**
+     * This signal is emitted whenever new matching contacts have been
+     * received, while the job is still running. This allows showing the
+     * first results before the search has finished.
+     *
+     * @param contacts The newly received contacts.
+     * @since 5.3
+     */
+    void contactsReceived(const KContacts::Addressee::List &contacts);
+
+protected:
+    void doStart() Q_DECL_OVERRIDE;
+
 private:
     //@cond PRIVATE
     class Private;
     Private *const d;
+
+    Q_PRIVATE_SLOT(d, void itemsReceived(const Akonadi::Item::List &))
     //@endcond
 };
 
@@ -0,0 +1,98 @@
+/*
+    This file is part of Akonadi Contact.
+
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef AKONADI_CONTACTSEARCHJOB_P_H
+#define AKONADI_CONTACTSEARCHJOB_P_H
+
+#include "akonadi-contactprivate_export.h"
+#include "contactsearchjob.h"
+
+#include <QtCore/QVector>
+
+namespace Akonadi
+{
+
+/**
+ * @internal
+ *
+ * The criteria of a ContactSearchJob, and how they are checked on the
+ * contacts returned by the storage or by a ContactSearchIndex.
+ */
+class AKONADI_CONTACT_TEST_EXPORT ContactSearchCriteria
+{
+public:
+    struct Query {
+        ContactSearchJob::Criterion criterion;
+        QString value;
+        ContactSearchJob::Match match;
+    };
+
+    ContactSearchCriteria();
+
+    /**
+     * Removes all criteria.
+     */
+    void clear();
+
+    /**
+     * @see ContactSearchJob::addQuery()
+     */
+    void addQuery(ContactSearchJob::Criterion criterion, const QString &value, ContactSearchJob::Match match);
+
+    /**
+     * Returns the criteria in the order they were added.
+     */
+    QVector<Query> queries() const;
+
+    /**
+     * @see ContactSearchJob::setQueryRelation()
+     */
+    void setRelation(ContactSearchJob::Relation relation);
+
+    /**
+     * Returns how the criteria are combined.
+     */
+    ContactSearchJob::Relation relation() const;
+
+    /**
+     * Returns whether the storage may return contacts which do not match
+     * the criteria, so that they have to be checked with matches().
+     */
+    bool needsFiltering() const;
+
+    /**
+     * Returns whether @p contact matches the criteria.
+     */
+    bool matches(const KContacts::Addressee &contact) const;
+
+    /**
+     * Returns the text to pass to ContactSearchIndex::search() to find
+     * every contact matching the criteria, and possibly more, or a null
+     * string if all indexed contacts have to be checked.
+     */
+    QString indexSearchText() const;
+
+private:
+    QVector<Query> mQueries;
+    ContactSearchJob::Relation mRelation;
+};
+
+}
+
+#endif
@@ -22,32 +22,247 @@
 #include "contactsfilterproxymodel.h"
 
 #include "contactstreemodel.h"
+#include "contactstreemodel_p.h"
+#include "contactsfilterworker_p.h"
 
 #include <entitytreemodel.h>
 #include <kcontacts/addressee.h>
 #include <kcontacts/contactgroup.h>
 
-static bool contactMatchesFilter(const KContacts::Addressee &contact, const QString &filterString);
-static bool contactGroupMatchesFilter(const KContacts::ContactGroup &group, const QString &filterString);
+#include <QtCore/QStringMatcher>
+#include <QtCore/QThread>
+
+static QString contactSearchText(const KContacts::Addressee &contact);
+static QString contactGroupSearchText(const KContacts::ContactGroup &group);
 
 using namespace Akonadi;
 
 class Q_DECL_HIDDEN ContactsFilterProxyModel::Private
 {
 public:
-    Private()
-        : flags(0)
+    /**
+     * The case folded text of all searchable fields of an item,
+     * separated by newlines.
+     */
+    struct SearchText {
+        int revision;
+        bool hasEmail;
+        bool matches;
+        uint matchSerial;
+        QString text;
+    };
+
+    /**
+     * Describes how the current filter relates to the previous one.
+     */
+    enum Refinement {
+        FullRefinement,     ///< All rows have to be matched again.
+        NarrowRefinement,   ///< Rows rejected by the previous filter stay rejected.
+        WidenRefinement     ///< Rows accepted by the previous filter stay accepted.
+    };
+
+    Private(ContactsFilterProxyModel *parent)
+        : q(parent)
+        , flags(0)
         , mExcludeVirtualCollections(false)
+        , mRefinement(FullRefinement)
+        , mMatchSerial(1)
+        , mAsynchronous(false)
+        , mWorkerThread(0)
+        , mWorker(0)
+    {
+    }
+
+    ~Private()
+    {
+        if (mWorkerThread) {
+            mWorker->cancel();
+            mWorkerThread->quit();
+            mWorkerThread->wait();
+        }
+    }
+
+    SearchText *searchText(const Akonadi::Item &item) const
     {
+        QHash<Akonadi::Item::Id, SearchText>::iterator it = mSearchTexts.find(item.id());
+        if (it != mSearchTexts.end() && it->revision == item.revision()) {
+            return &it.value();
+        }
+
+        SearchText searchText;
+        searchText.revision = item.revision();
+        searchText.matches = false;
+        searchText.matchSerial = 0;
+        if (item.hasPayload<KContacts::Addressee>()) {
+            const KContacts::Addressee contact = item.payload<KContacts::Addressee>();
+            searchText.hasEmail = !contact.emails().isEmpty();
+            searchText.text = contactSearchText(contact);
+        } else if (item.hasPayload<KContacts::ContactGroup>()) {
+            searchText.hasEmail = false;
+            searchText.text = contactGroupSearchText(item.payload<KContacts::ContactGroup>());
+        } else {
+            return 0;
+        }
+
+        if (mAsynchronous) {
+            ContactsFilterKey key;
+            key.revision = searchText.revision;
+            key.text = searchText.text;
+            mSearchKeys.insert(item.id(), key);
+        }
+
+        return &mSearchTexts.insert(item.id(), searchText).value();
     }
+
+    bool matchesFilter(SearchText *searchText) const
+    {
+        if (searchText->matchSerial == mMatchSerial) {
+            return searchText->matches;
+        }
+
+        // The result for the previous filter decides the row without a
+        // scan if the filter has only been extended or shortened since.
+        const bool matchedPrevious = (searchText->matchSerial == mMatchSerial - 1);
+        if (matchedPrevious && mRefinement == NarrowRefinement && !searchText->matches) {
+            searchText->matchSerial = mMatchSerial;
+            return false;
+        }
+        if (matchedPrevious && mRefinement == WidenRefinement && searchText->matches) {
+            searchText->matchSerial = mMatchSerial;
+            return true;
+        }
+
+        searchText->matches = (mFilterMatcher.indexIn(searchText->text) != -1);
+        searchText->matchSerial = mMatchSerial;
+        return searchText->matches;
+    }
+
+    void setFilter(const QString &filter)
+    {
+        const QString previousFilter = mFilterMatcher.pattern();
+        const QString foldedFilter = filter.toCaseFolded();
+
+        if (previousFilter.isEmpty() || foldedFilter.isEmpty()) {
+            mRefinement = FullRefinement;
+        } else if (foldedFilter.contains(previousFilter)) {
+            mRefinement = NarrowRefinement;
+        } else if (previousFilter.contains(foldedFilter)) {
+            mRefinement = WidenRefinement;
+        } else {
+            mRefinement = FullRefinement;
+        }
+
+        mFilter = filter;
+        mFilterMatcher.setPattern(foldedFilter);
+        ++mMatchSerial;
+    }
+
+    bool asynchronousMatchesFilter(const Akonadi::Item &item, SearchText *searchText) const
+    {
+        // Items that were not part of the snapshot the last worker result was
+        // computed from, or that changed since, are matched synchronously.
+        const ContactsFilterKeys::const_iterator it = mAppliedKeys.constFind(item.id());
+        if (it != mAppliedKeys.constEnd() && it->revision == item.revision()) {
+            return mMatchedIds.contains(item.id());
+        }
+
+        return matchesFilter(searchText);
+    }
+
+    void startWorker()
+    {
+        if (mWorkerThread) {
+            return;
+        }
+
+        mWorkerThread = new QThread(q);
+        mWorker = new ContactsFilterWorker;
+        mWorker->moveToThread(mWorkerThread);
+        q->connect(mWorkerThread, SIGNAL(finished()), mWorker, SLOT(deleteLater()));
+        q->connect(mWorker, SIGNAL(matched(uint,QSet<qint64>)), q, SLOT(filterMatched(uint,QSet<qint64>)));
+        mWorkerThread->start();
+    }
+
+    void requestMatches()
+    {
+        // Hands an implicitly shared copy of the keys to the worker, so
+        // it never sees keys that are added or changed in the meantime.
+        mPendingKeys = mSearchKeys;
+        mWorker->request(mMatchSerial, mPendingKeys, mFilterMatcher.pattern());
+    }
+
+    void cancelMatches()
+    {
+        if (mWorker) {
+            mWorker->cancel();
+        }
+        mPendingKeys.clear();
+        mAppliedKeys.clear();
+        mMatchedIds.clear();
+    }
+
+    void filterMatched(uint serial, const QSet<qint64> &ids)
+    {
+        if (serial != mMatchSerial) {
+            // the filter changed while the worker was busy
+            return;
+        }
+
+        mAppliedKeys = mPendingKeys;
+        mPendingKeys.clear();
+        mMatchedIds = ids;
+        q->invalidateFilter();
+    }
+
+    void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+    {
+        const QAbstractItemModel *model = q->sourceModel();
+        for (int row = first; row <= last; ++row) {
+            const QModelIndex index = model->index(row, 0, parent);
+            const Akonadi::Item item = index.data(Akonadi::EntityTreeModel::ItemRole).value<Akonadi::Item>();
+            if (item.isValid()) {
+                mSearchTexts.remove(item.id());
+                mSearchKeys.remove(item.id());
+            }
+
+            // the items of a removed collection go with it
+            const int childCount = model->rowCount(index);
+            if (childCount > 0) {
+                sourceRowsAboutToBeRemoved(index, 0, childCount - 1);
+            }
+        }
+    }
+
+    void clearSearchTexts()
+    {
+        mSearchTexts.clear();
+        mSearchKeys.clear();
+        mAppliedKeys.clear();
+        mMatchedIds.clear();
+    }
+
+    ContactsFilterProxyModel *q;
+
     QString mFilter;
+    QStringMatcher mFilterMatcher;
     ContactsFilterProxyModel::FilterFlags flags;
     bool mExcludeVirtualCollections;
+    Refinement mRefinement;
+    uint mMatchSerial;
+    mutable QHash<Akonadi::Item::Id, SearchText> mSearchTexts;
+
+    bool mAsynchronous;
+    QThread *mWorkerThread;
+    ContactsFilterWorker *mWorker;
+    mutable ContactsFilterKeys mSearchKeys;
+    ContactsFilterKeys mPendingKeys;
+    ContactsFilterKeys mAppliedKeys;
+    QSet<qint64> mMatchedIds;
 };
 
 ContactsFilterProxyModel::ContactsFilterProxyModel(QObject *parent)
     : QSortFilterProxyModel(parent)
-    , d(new Private)
+    , d(new Private(this))
 {
     // contact names should be sorted correctly
     setSortLocaleAware(true);
@@ -61,10 +276,42 @@ ContactsFilterProxyModel::~ContactsFilterProxyModel()
 
 void ContactsFilterProxyModel::setFilterString(const QString &filter)
 {
-    d->mFilter = filter;
+    if (filter == d->mFilter) {
+        return;
+    }
+
+    d->setFilter(filter);
+
+    if (d->mAsynchronous) {
+        if (!d->mFilter.isEmpty()) {
+            // the view is updated once the worker is done
+            d->requestMatches();
+            return;
+        }
+        d->cancelMatches();
+    }
+
     invalidateFilter();
 }
 
+void ContactsFilterProxyModel::setSourceModel(QAbstractItemModel *model)
+{
+    if (sourceModel()) {
+        disconnect(sourceModel(), SIGNAL(modelReset()), this, SLOT(clearSearchTexts()));
+        disconnect(sourceModel(), SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+                   this, SLOT(sourceRowsAboutToBeRemoved(QModelIndex,int,int)));
+    }
+    d->clearSearchTexts();
+
+    QSortFilterProxyModel::setSourceModel(model);
+
+    if (model) {
+        connect(model, SIGNAL(modelReset()), this, SLOT(clearSearchTexts()));
+        connect(model, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+                this, SLOT(sourceRowsAboutToBeRemoved(QModelIndex,int,int)));
+    }
+}
+
 bool ContactsFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
 {
     const QModelIndex index = sourceModel()->index(row, 0, parent);
@@ -75,29 +322,28 @@ bool ContactsFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &pare
         }
     }
 
-    if ((d->mFilter.isEmpty()) && (!(d->flags & ContactsFilterProxyModel::HasEmail))) {
+    // In asynchronous mode the search text of every item is collected
+    // up front, so that the worker has a complete snapshot to match.
+    if ((d->mFilter.isEmpty()) && (!(d->flags & ContactsFilterProxyModel::HasEmail)) && !d->mAsynchronous) {
         return true;
     }
 
     const Akonadi::Item item = index.data(Akonadi::EntityTreeModel::ItemRole).value<Akonadi::Item>();
 
-    if (item.hasPayload<KContacts::Addressee>()) {
-        const KContacts::Addressee contact = item.payload<KContacts::Addressee>();
-        if (d->flags & ContactsFilterProxyModel::HasEmail) {
-            if (contact.emails().isEmpty()) {
-                return false;
-            }
-        }
-        if (!d->mFilter.isEmpty()) {
-            return contactMatchesFilter(contact, d->mFilter);
-        }
-    } else {
-        if (!d->mFilter.isEmpty()) {
-            if (item.hasPayload<KContacts::ContactGroup>()) {
-                const KContacts::ContactGroup group = item.payload<KContacts::ContactGroup>();
-                return contactGroupMatchesFilter(group, d->mFilter);
-            }
+    Private::SearchText *searchText = d->searchText(item);
+    if (!searchText) {
+        return true;
+    }
+
+    if ((d->flags & ContactsFilterProxyModel::HasEmail) && item.hasPayload<KContacts::Addressee>() && !searchText->hasEmail) {
+        return false;
+    }
+
+    if (!d->mFilter.isEmpty()) {
+        if (d->mAsynchronous) {
+            return d->asynchronousMatchesFilter(item, searchText);
         }
+        return d->matchesFilter(searchText);
     }
 
     return true;
@@ -105,17 +351,23 @@ bool ContactsFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &pare
 
 bool ContactsFilterProxyModel::lessThan(const QModelIndex &leftIndex, const QModelIndex &rightIndex) const
 {
-    const QDate leftDate = leftIndex.data(ContactsTreeModel::DateRole).toDate();
-    const QDate rightDate = rightIndex.data(ContactsTreeModel::DateRole).toDate();
-    if (leftDate.isValid() && rightDate.isValid()) {
-        if (leftDate.month() < rightDate.month()) {
-            return true;
-        } else if (leftDate.month() == rightDate.month()) {
-            if (leftDate.day() < rightDate.day()) {
-                return true;
-            }
-        } else {
-            return false;
+    const QVariant leftBirthday = leftIndex.data(BirthdaySortRole);
+    const QVariant rightBirthday = rightIndex.data(BirthdaySortRole);
+    if (leftBirthday.isValid() && rightBirthday.isValid()) {
+        const int left = leftBirthday.toInt();
+        const int right = rightBirthday.toInt();
+        if (left != right) {
+            return left < right;
+        }
+    }
+
+    // Compare the collation keys cached by ContactsTreeModel, instead of
+    // collating the display texts again for every comparison.
+    if (isSortLocaleAware() && sortRole() == Qt::DisplayRole) {
+        const QVariant leftKey = leftIndex.data(CollationKeyRole);
+        const QVariant rightKey = rightIndex.data(CollationKeyRole);
+        if (leftKey.isValid() && rightKey.isValid()) {
+            return leftKey.value<ContactCollationKey>().compare(rightKey.value<ContactCollationKey>()) < 0;
         }
     }
 
@@ -124,7 +376,11 @@ bool ContactsFilterProxyModel::lessThan(const QModelIndex &leftIndex, const QMod
 
 void ContactsFilterProxyModel::setFilterFlags(ContactsFilterProxyModel::FilterFlags flags)
 {
-    d->flags = flags;
+    if (flags != d->flags) {
+        d->flags = flags;
+        // setFilterString() does nothing if the filter string is unchanged
+        invalidateFilter();
+    }
 }
 
 void ContactsFilterProxyModel::setExcludeVirtualCollections(bool exclude)
@@ -135,6 +391,44 @@ void ContactsFilterProxyModel::setExcludeVirtualCollections(bool exclude)
     }
 }
 
+void ContactsFilterProxyModel::setAsynchronousFiltering(bool enable)
+{
+    if (enable == d->mAsynchronous) {
+        return;
+    }
+
+    d->mAsynchronous = enable;
+    if (enable) {
+        d->startWorker();
+
+        QHash<Akonadi::Item::Id, Private::SearchText>::const_iterator it = d->mSearchTexts.constBegin();
+        const QHash<Akonadi::Item::Id, Private::SearchText>::const_iterator end = d->mSearchTexts.constEnd();
+        for (; it != end; ++it) {
+            ContactsFilterKey key;
+            key.revision = it->revision;
+            key.text = it->text;
+            d->mSearchKeys.insert(it.key(), key);
+        }
+
+        if (!d->mFilter.isEmpty()) {
+            // the rows shown already match the filter, the view is
+            // updated once the worker is done
+            d->requestMatches();
+            return;
+        }
+    } else {
+        d->cancelMatches();
+        d->mSearchKeys.clear();
+    }
+
+    invalidateFilter();
+}
+
+bool ContactsFilterProxyModel::asynchronousFiltering() const
+{
+    return d->mAsynchronous;
+}
+
 Qt::ItemFlags ContactsFilterProxyModel::flags(const QModelIndex &index) const
 {
     if (!index.isValid()) {
@@ -148,143 +442,73 @@ Qt::ItemFlags ContactsFilterProxyModel::flags(const QModelIndex &index) const
     return QSortFilterProxyModel::flags(index);
 }
 
-static bool addressMatchesFilter(const KContacts::Address &address, const QString &filterString)
+static void appendSearchText(QString &text, const QString &value)
 {
-    if (address.street().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
-    }
-
-    if (address.locality().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
-    }
-
-    if (address.region().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
-    }
-
-    if (address.postalCode().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
+    if (!value.isEmpty()) {
+        text += value;
+        text += QLatin1Char('\n');
     }
-
-    if (address.country().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
-    }
-
-    if (address.label().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
-    }
-
-    if (address.postOfficeBox().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
-    }
-
-    return false;
 }
 
-static bool contactMatchesFilter(const KContacts::Addressee &contact, const QString &filterString)
+static QString contactSearchText(const KContacts::Addressee &contact)
 {
-    if (contact.assembledName().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
-    }
+    QString text;
 
-    if (contact.formattedName().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
-    }
-
-    if (contact.nickName().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
-    }
-
-    if (contact.birthday().toString().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
-    }
-
-    const KContacts::Address::List addresses = contact.addresses();
-    int count = addresses.count();
-    for (int i = 0; i < count; ++i) {
-        if (addressMatchesFilter(addresses.at(i), filterString)) {
-            return true;
-        }
-    }
-
-    const KContacts::PhoneNumber::List phoneNumbers = contact.phoneNumbers();
-    count = phoneNumbers.count();
-    for (int i = 0; i < count; ++i) {
-        if (phoneNumbers.at(i).number().contains(filterString, Qt::CaseInsensitive)) {
-            return true;
-        }
-    }
-
-    const QStringList emails = contact.emails();
-    count = emails.count();
-    for (int i = 0; i < count; ++i) {
-        if (emails.at(i).contains(filterString, Qt::CaseInsensitive)) {
-            return true;
-        }
-    }
-
-    const QStringList categories = contact.categories();
-    count = categories.count();
-    for (int i = 0; i < count; ++i) {
-        if (categories.at(i).contains(filterString, Qt::CaseInsensitive)) {
-            return true;
-        }
-    }
-
-    if (contact.mailer().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
-    }
+    appendSearchText(text, contact.assembledName());
+    appendSearchText(text, contact.formattedName());
+    appendSearchText(text, contact.nickName());
+    appendSearchText(text, contact.birthday().toString());
 
-    if (contact.title().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
+    foreach (const KContacts::Address &address, contact.addresses()) {
+        appendSearchText(text, address.street());
+        appendSearchText(text, address.locality());
+        appendSearchText(text, address.region());
+        appendSearchText(text, address.postalCode());
+        appendSearchText(text, address.country());
+        appendSearchText(text, address.label());
+        appendSearchText(text, address.postOfficeBox());
     }
 
-    if (contact.role().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
+    foreach (const KContacts::PhoneNumber &phoneNumber, contact.phoneNumbers()) {
+        appendSearchText(text, phoneNumber.number());
     }
 
-    if (contact.organization().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
+    foreach (const QString &email, contact.emails()) {
+        appendSearchText(text, email);
     }
 
-    if (contact.department().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
+    foreach (const QString &category, contact.categories()) {
+        appendSearchText(text, category);
     }
 
-    if (contact.note().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
-    }
+    appendSearchText(text, contact.mailer());
+    appendSearchText(text, contact.title());
+    appendSearchText(text, contact.role());
+    appendSearchText(text, contact.organization());
+    appendSearchText(text, contact.department());
+    appendSearchText(text, contact.note());
+    appendSearchText(text, contact.url().url().url());
 
-    if (contact.url().url().url().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
+    foreach (const QString &custom, contact.customs()) {
+        appendSearchText(text, custom);
     }
 
-    const QStringList customs = contact.customs();
-    count = customs.count();
-    for (int i = 0; i < count; ++i) {
-        if (customs.at(i).contains(filterString, Qt::CaseInsensitive)) {
-            return true;
-        }
-    }
-
-    return false;
+    return text.toCaseFolded();
 }
 
-bool contactGroupMatchesFilter(const KContacts::ContactGroup &group, const QString &filterString)
+static QString contactGroupSearchText(const KContacts::ContactGroup &group)
 {
-    if (group.name().contains(filterString, Qt::CaseInsensitive)) {
-        return true;
-    }
+    QString text;
+
+    appendSearchText(text, group.name());
 
     const uint count = group.dataCount();
     for (uint i = 0; i < count; ++i) {
-        if (group.data(i).name().contains(filterString, Qt::CaseInsensitive)) {
-            return true;
-        }
-        if (group.data(i).email().contains(filterString, Qt::CaseInsensitive)) {
-            return true;
-        }
+        appendSearchText(text, group.data(i).name());
+        appendSearchText(text, group.data(i).email());
     }
 
-    return false;
+    return text.toCaseFolded();
 }
+
+#include "moc_contactsfilterproxymodel.cpp"
@@ -101,6 +101,36 @@ public:
      */
     void setExcludeVirtualCollections(bool exclude);
 
+    /**
+     * Sets whether the filter string is matched on a worker thread.
+     *
+     * In asynchronous mode, changing the filter string does not block
+     * until all contacts have been matched. The filter is matched in the
+     * background against a snapshot of the contacts' search data, and the
+     * proxy is updated in one go once the result is available. Results for
+     * a filter string that has been replaced in the meantime are dropped.
+     * By default, filtering is synchronous.
+     *
+     * @param enable If true, filtering is done asynchronously.
+     *
+     * @since 5.3
+     */
+    void setAsynchronousFiltering(bool enable);
+
+    /**
+     * Returns whether the filter string is matched on a worker thread.
+     *
+     * @since 5.3
+     */
+    bool asynchronousFiltering() const;
+
+    /**
+     * Reimplemented to clear the cached search data of the previous model,
+     * and to drop the search data of rows removed from the new one.
+     * @param model the source model to set
+     */
+    void setSourceModel(QAbstractItemModel *model) Q_DECL_OVERRIDE;
+
 public Q_SLOTS:
     /**
      * Sets the @p filter that is used to filter for matching contacts
@@ -118,6 +148,10 @@ private:
     //@cond PRIVATE
     class Private;
     Private *const d;
+
+    Q_PRIVATE_SLOT(d, void sourceRowsAboutToBeRemoved(const QModelIndex &, int, int))
+    Q_PRIVATE_SLOT(d, void clearSearchTexts())
+    Q_PRIVATE_SLOT(d, void filterMatched(uint, const QSet<qint64> &))
     //@endcond
 };
 
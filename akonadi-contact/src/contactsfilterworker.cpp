@@ -0,0 +1,89 @@
+/*
+    This file is part of Akonadi Contact.
+
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "contactsfilterworker_p.h"
+
+#include <QtCore/QMutexLocker>
+#include <QtCore/QStringMatcher>
+
+using namespace Akonadi;
+
+// Number of keys matched between checks for a newer request
+static const int s_cancelCheckInterval = 256;
+
+ContactsFilterWorker::ContactsFilterWorker(QObject *parent)
+    : QObject(parent)
+    , mLatestSerial(0)
+{
+    qRegisterMetaType<QSet<qint64> >();
+}
+
+void ContactsFilterWorker::request(uint serial, const ContactsFilterKeys &keys, const QString &filter)
+{
+    QMutexLocker locker(&mMutex);
+    mKeys = keys;
+    mFilter = filter;
+    mLatestSerial.storeRelease(int(serial));
+    locker.unlock();
+
+    QMetaObject::invokeMethod(this, "processRequest", Qt::QueuedConnection);
+}
+
+void ContactsFilterWorker::cancel()
+{
+    QMutexLocker locker(&mMutex);
+    mKeys.clear();
+    mFilter.clear();
+    mLatestSerial.storeRelease(0);
+}
+
+void ContactsFilterWorker::processRequest()
+{
+    QMutexLocker locker(&mMutex);
+    if (mFilter.isNull()) {
+        // already handled by an earlier invocation, or cancelled
+        return;
+    }
+
+    const uint serial = uint(mLatestSerial.loadAcquire());
+    const ContactsFilterKeys keys = mKeys;
+    const QStringMatcher matcher(mFilter);
+    mKeys.clear();
+    mFilter.clear();
+    locker.unlock();
+
+    QSet<qint64> ids;
+    int checked = 0;
+    ContactsFilterKeys::const_iterator it = keys.constBegin();
+    const ContactsFilterKeys::const_iterator end = keys.constEnd();
+    for (; it != end; ++it) {
+        if (++checked == s_cancelCheckInterval) {
+            if (uint(mLatestSerial.loadAcquire()) != serial) {
+                return;
+            }
+            checked = 0;
+        }
+
+        if (matcher.indexIn(it->text) != -1) {
+            ids.insert(it.key());
+        }
+    }
+
+    Q_EMIT matched(serial, ids);
+}
@@ -0,0 +1,94 @@
+/*
+    This file is part of Akonadi Contact.
+
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef AKONADI_CONTACTSFILTERWORKER_P_H
+#define AKONADI_CONTACTSFILTERWORKER_P_H
+
+#include <item.h>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QSet>
+
+namespace Akonadi
+{
+
+/**
+ * @internal
+ *
+ * The case folded search text of an item, as matched by the filter worker.
+ */
+struct ContactsFilterKey {
+    int revision;
+    QString text;
+};
+
+typedef QHash<Akonadi::Item::Id, ContactsFilterKey> ContactsFilterKeys;
+
+/**
+ * @internal
+ *
+ * Matches a filter against a snapshot of search keys on a worker thread
+ * for ContactsFilterProxyModel.
+ *
+ * Only the most recent request is processed: requests that were replaced
+ * before the worker got to them are dropped, and a match in progress is
+ * abandoned as soon as a newer request comes in.
+ */
+class ContactsFilterWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ContactsFilterWorker(QObject *parent = Q_NULLPTR);
+
+    /**
+     * Requests matching @p filter, which must be case folded, against
+     * @p keys. Can be called from any thread.
+     */
+    void request(uint serial, const ContactsFilterKeys &keys, const QString &filter);
+
+    /**
+     * Drops the pending request and abandons a match in progress.
+     * Can be called from any thread.
+     */
+    void cancel();
+
+Q_SIGNALS:
+    /**
+     * Emitted with the ids of all items whose key contains the filter
+     * of the request @p serial.
+     */
+    void matched(uint serial, const QSet<qint64> &ids);
+
+private Q_SLOTS:
+    void processRequest();
+
+private:
+    QMutex mMutex;
+    QAtomicInt mLatestSerial;
+    ContactsFilterKeys mKeys;
+    QString mFilter;
+};
+
+}
+
+#endif
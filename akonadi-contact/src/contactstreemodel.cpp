@@ -21,6 +21,8 @@
 */
 
 #include "contactstreemodel.h"
+#include "contactstreemodel_p.h"
+#include "contactthumbnailloader_p.h"
 
 #include <kcontacts/addressee.h>
 #include <kcontacts/contactgroup.h>
@@ -29,28 +31,495 @@
 #include <KLocalizedString>
 #include <KLocalizedString>
 
+#include <QCache>
+#include <QCollator>
 #include <QIcon>
 #include <QLocale>
+#include <QSet>
+#include <QThread>
 
 using namespace Akonadi;
 
+// Memory used by cached photo thumbnails, in bytes
+static const int s_maximumThumbnailBytes = 8 * 1024 * 1024;
+
+static QVariant contactColumnData(const KContacts::Addressee &contact, ContactsTreeModel::Column column)
+{
+    switch (column) {
+    case ContactsTreeModel::FullName:
+        if (contact.realName().isEmpty()) {
+            if (contact.preferredEmail().isEmpty()) {
+                return contact.familyName();
+            }
+            return contact.preferredEmail();
+        }
+        return contact.realName();
+    case ContactsTreeModel::FamilyName:
+        return contact.familyName();
+    case ContactsTreeModel::GivenName:
+        return contact.givenName();
+    case ContactsTreeModel::Birthday:
+        if (contact.birthday().date().isValid()) {
+            return QLocale().toString(contact.birthday().date(), QLocale::ShortFormat);
+        }
+        break;
+    case ContactsTreeModel::HomeAddress: {
+        const KContacts::Address address = contact.address(KContacts::Address::Home);
+        if (!address.isEmpty()) {
+            return address.formattedAddress();
+        }
+        break;
+    }
+    case ContactsTreeModel::BusinessAddress: {
+        const KContacts::Address address = contact.address(KContacts::Address::Work);
+        if (!address.isEmpty()) {
+            return address.formattedAddress();
+        }
+        break;
+    }
+    case ContactsTreeModel::PhoneNumbers: {
+        QStringList values;
+
+        const KContacts::PhoneNumber::List numbers = contact.phoneNumbers();
+        foreach (const KContacts::PhoneNumber &number, numbers) {
+            values += number.number();
+        }
+
+        return values.join(QStringLiteral("\n"));
+        break;
+    }
+    case ContactsTreeModel::PreferredEmail:
+        return contact.preferredEmail();
+    case ContactsTreeModel::AllEmails:
+        return contact.emails().join(QStringLiteral("\n"));
+    case ContactsTreeModel::Organization:
+        return contact.organization();
+    case ContactsTreeModel::Role:
+        return contact.role();
+    case ContactsTreeModel::Homepage:
+        return contact.url().url();
+    case ContactsTreeModel::Note:
+        return contact.note();
+    }
+
+    return QVariant();
+}
+
+// The month and day of a birthday packed into an int, or -1
+static int packedBirthday(const QDate &birthday)
+{
+    return birthday.isValid() ? (birthday.month() << 5) | birthday.day() : -1;
+}
+
 class Q_DECL_HIDDEN ContactsTreeModel::Private
 {
 public:
-    Private()
-        : mColumns(ContactsTreeModel::Columns() << ContactsTreeModel::FullName)
+    Private(ContactsTreeModel *parent)
+        : q(parent)
+        , mColumns(ContactsTreeModel::Columns() << ContactsTreeModel::FullName)
         , mIconSize(KIconLoader::global()->currentSize(KIconLoader::Small))
+        , mThumbnails(s_maximumThumbnailBytes)
+        , mThumbnailThread(0)
+        , mThumbnailLoader(0)
     {
     }
 
+    ~Private()
+    {
+        if (mThumbnailThread) {
+            mThumbnailLoader->cancel();
+            mThumbnailThread->quit();
+            mThumbnailThread->wait();
+        }
+    }
+
+    /**
+     * A photo scaled to icon size, for the given revision of an item.
+     */
+    struct Thumbnail {
+        int revision;
+        QImage image;
+    };
+
+    QVariant photoDecoration(const Akonadi::Item &item) const
+    {
+        const Thumbnail *thumbnail = mThumbnails.object(item.id());
+        if (thumbnail && thumbnail->revision == item.revision()) {
+            if (!thumbnail->image.isNull()) {
+                return thumbnail->image;
+            }
+        } else {
+            requestThumbnail(item);
+        }
+
+        // shown until the thumbnail is loaded
+        return QIcon::fromTheme(QStringLiteral("user-identity"));
+    }
+
+    void requestThumbnail(const Akonadi::Item &item) const
+    {
+        QHash<Akonadi::Item::Id, int>::const_iterator it = mPendingThumbnails.constFind(item.id());
+        if (it != mPendingThumbnails.constEnd() && it.value() == item.revision()) {
+            return;
+        }
+
+        if (!mThumbnailThread) {
+            mThumbnailThread = new QThread(q);
+            mThumbnailLoader = new ContactThumbnailLoader;
+            mThumbnailLoader->moveToThread(mThumbnailThread);
+            q->connect(mThumbnailThread, SIGNAL(finished()), mThumbnailLoader, SLOT(deleteLater()));
+            q->connect(mThumbnailLoader, SIGNAL(thumbnailLoaded(qint64,int,QImage)),
+                       q, SLOT(thumbnailLoaded(qint64,int,QImage)));
+            mThumbnailThread->start(QThread::LowPriority);
+        }
+
+        // Decoding is left to the loader, unless the picture has no encoded data.
+        const KContacts::Picture picture = item.payload<KContacts::Addressee>().photo();
+        const QByteArray rawData = picture.rawData();
+        mThumbnailLoader->request(item.id(), item.revision(), rawData,
+                                  rawData.isEmpty() ? picture.data() : QImage(), mIconSize);
+        mPendingThumbnails.insert(item.id(), item.revision());
+    }
+
+    void thumbnailLoaded(qint64 id, int revision, const QImage &image)
+    {
+        QHash<Akonadi::Item::Id, int>::iterator it = mPendingThumbnails.find(id);
+        if (it != mPendingThumbnails.end() && it.value() == revision) {
+            mPendingThumbnails.erase(it);
+        }
+
+        Thumbnail *thumbnail = new Thumbnail;
+        thumbnail->revision = revision;
+        thumbnail->image = image;
+        mThumbnails.insert(id, thumbnail, qMax(1, image.byteCount()));
+
+        const QModelIndexList indexes = EntityTreeModel::modelIndexesForItem(q, Akonadi::Item(id));
+        foreach (const QModelIndex &index, indexes) {
+            Q_EMIT q->dataChanged(index, index, QVector<int>() << Qt::DecorationRole);
+        }
+    }
+
+    /**
+     * The values an item provides for the configured columns, rendered
+     * once per item revision.
+     */
+    struct ItemData {
+        int revision;
+        QVector<QVariant> values;
+        QDateTime birthday;
+        int packedBirthday;
+        bool hasPhoto;
+        QVector<ContactCollationKey> collationKeys;
+    };
+
+    const ItemData &itemData(const Akonadi::Item &item) const
+    {
+        QHash<Akonadi::Item::Id, ItemData>::const_iterator it = mItemData.constFind(item.id());
+        if (it != mItemData.constEnd() && it->revision == item.revision()) {
+            return it.value();
+        }
+
+        ItemData data;
+        data.revision = item.revision();
+        data.packedBirthday = -1;
+        data.hasPhoto = false;
+        data.values.reserve(mColumns.count());
+
+        if (item.hasPayload<KContacts::Addressee>()) {
+            const KContacts::Addressee contact = item.payload<KContacts::Addressee>();
+            foreach (ContactsTreeModel::Column column, mColumns) {
+                data.values.append(contactColumnData(contact, column));
+            }
+
+            data.birthday = contact.birthday();
+            data.packedBirthday = packedBirthday(data.birthday.date());
+            // the photo itself is only kept as a thumbnail
+            data.hasPhoto = contact.photo().isIntern();
+        } else if (item.hasPayload<KContacts::ContactGroup>()) {
+            const QString name = item.payload<KContacts::ContactGroup>().name();
+            foreach (ContactsTreeModel::Column column, mColumns) {
+                data.values.append(column == ContactsTreeModel::FullName ? QVariant(name) : QVariant());
+            }
+        }
+
+        return mItemData.insert(item.id(), data).value();
+    }
+
+    const QVector<ContactCollationKey> &collationKeys(const Akonadi::Item &item) const
+    {
+        const ItemData &data = itemData(item);
+        if (data.collationKeys.isEmpty()) {
+            // built on the first sort only, most items are just displayed
+            QVector<ContactCollationKey> &keys = mItemData[item.id()].collationKeys;
+            keys.reserve(data.values.count());
+            foreach (const QVariant &value, data.values) {
+                keys.append(ContactCollationKey(mCollator.sortKey(value.toString())));
+            }
+        }
+
+        return data.collationKeys;
+    }
+
+    void rowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+    {
+        for (int row = first; row <= last; ++row) {
+            const QModelIndex index = q->index(row, 0, parent);
+            const Akonadi::Item item = index.data(EntityTreeModel::ItemRole).value<Akonadi::Item>();
+            if (item.isValid()) {
+                mItemData.remove(item.id());
+                mThumbnails.remove(item.id());
+                mPendingThumbnails.remove(item.id());
+            }
+
+            // the items of a removed collection go with it
+            const int childCount = q->rowCount(index);
+            if (childCount > 0) {
+                rowsAboutToBeRemoved(index, 0, childCount - 1);
+            }
+        }
+    }
+
+    void clearItemData()
+    {
+        mItemData.clear();
+    }
+
+    void rowsInserted(const QModelIndex &parent, int first, int last)
+    {
+        for (int row = first; row <= last; ++row) {
+            const QModelIndex index = q->index(row, 0, parent);
+            if (index.data(EntityTreeModel::CollectionRole).value<Akonadi::Collection>().isValid()) {
+                mCollectionIndexes.append(index);
+            }
+        }
+    }
+
+    /**
+     * Returns the indexes of all collections, which are the only parents
+     * besides the root that have columns, see ContactsTreeModel::columnCount().
+     */
+    QModelIndexList collectionIndexes()
+    {
+        QModelIndexList indexes;
+        indexes.reserve(mCollectionIndexes.count());
+
+        QList<QPersistentModelIndex>::iterator it = mCollectionIndexes.begin();
+        while (it != mCollectionIndexes.end()) {
+            if (it->isValid()) {
+                indexes << *it;
+                ++it;
+            } else {
+                // the collection has been removed
+                it = mCollectionIndexes.erase(it);
+            }
+        }
+
+        return indexes;
+    }
+
+    /**
+     * Removes the columns @p first to @p last, notifying each of @p parents
+     * in turn. Until its own notification, a parent keeps reporting the
+     * previous columns, see previousData(), so that every parent's columns
+     * are consistent with the signals it has received.
+     */
+    void removeColumns(const QModelIndexList &parents, int first, int last)
+    {
+        mPreviousColumns = mColumns;
+        mPendingParents = parents.toSet();
+
+        for (int i = 0; i < parents.count(); ++i) {
+            q->beginRemoveColumns(parents.at(i), first, last);
+            if (i == 0) {
+                mColumns.erase(mColumns.begin() + first, mColumns.begin() + last + 1);
+                mItemData.clear();
+            }
+            mPendingParents.remove(parents.at(i));
+            q->endRemoveColumns();
+        }
+
+        mPreviousColumns.clear();
+    }
+
+    /**
+     * Inserts @p columns at @p first, notifying each of @p parents in turn,
+     * see removeColumns().
+     */
+    void insertColumns(const QModelIndexList &parents, int first, const Columns &columns)
+    {
+        mPreviousColumns = mColumns;
+        mPendingParents = parents.toSet();
+
+        for (int i = 0; i < parents.count(); ++i) {
+            q->beginInsertColumns(parents.at(i), first, first + columns.count() - 1);
+            if (i == 0) {
+                for (int column = 0; column < columns.count(); ++column) {
+                    mColumns.insert(first + column, columns.at(column));
+                }
+                mItemData.clear();
+            }
+            mPendingParents.remove(parents.at(i));
+            q->endInsertColumns();
+        }
+
+        mPreviousColumns.clear();
+    }
+
+    /**
+     * Returns the data of @p index in a parent that has not been notified
+     * of the current column change yet, in the previous columns.
+     */
+    QVariant previousData(const QModelIndex &index, int role) const
+    {
+        const QModelIndex firstColumn = index.sibling(index.row(), 0);
+        const Akonadi::Item item = q->EntityTreeModel::data(firstColumn, EntityTreeModel::ItemRole).value<Akonadi::Item>();
+        if (!item.isValid()) {
+            // collections have the same columns before and after the change
+            return q->EntityTreeModel::data(index, role);
+        }
+
+        const ContactsTreeModel::Column column = mPreviousColumns.at(index.column());
+        switch (role) {
+        case Qt::DisplayRole:
+        case Qt::EditRole:
+        case ContactsTreeModel::DateRole:
+        case BirthdaySortRole:
+            break;
+        case Qt::DecorationRole:
+            return index.column() == 0 ? q->EntityTreeModel::data(firstColumn, role) : QVariant();
+        case CollationKeyRole:
+            // sorting falls back to the display text
+            return QVariant();
+        default:
+            // the other roles do not depend on the column
+            return q->EntityTreeModel::data(firstColumn, role);
+        }
+
+        if (item.hasPayload<KContacts::Addressee>()) {
+            const KContacts::Addressee contact = item.payload<KContacts::Addressee>();
+            if (role == ContactsTreeModel::DateRole) {
+                return column == ContactsTreeModel::Birthday ? QVariant(contact.birthday()) : QVariant(QDate());
+            } else if (role == BirthdaySortRole) {
+                const int birthday = packedBirthday(contact.birthday().date());
+                return column == ContactsTreeModel::Birthday && birthday != -1 ? QVariant(birthday) : QVariant();
+            }
+            return contactColumnData(contact, column);
+        } else if (item.hasPayload<KContacts::ContactGroup>()) {
+            if (role == Qt::DisplayRole || role == Qt::EditRole) {
+                const QString name = item.payload<KContacts::ContactGroup>().name();
+                return column == ContactsTreeModel::FullName ? QVariant(name) : QVariant();
+            }
+        } else if (role == Qt::DisplayRole) {
+            return item.remoteId();
+        }
+
+        return QVariant();
+    }
+
+    /**
+     * Changes the columns to @p columns by removing and inserting columns,
+     * so that views and proxy models keep their row mappings.
+     *
+     * Returns false if the change cannot be expressed that way, because
+     * columns are reordered or duplicated, or no column is kept.
+     */
+    bool changeColumns(const Columns &columns)
+    {
+        if (mColumns.isEmpty() || columns.isEmpty()) {
+            return false;
+        }
+
+        // the columns that are kept must stay in the same order, and at
+        // least one must be kept, as the model never has less than one column
+        Columns keptColumns;
+        foreach (ContactsTreeModel::Column column, mColumns) {
+            if (mColumns.count(column) != 1) {
+                return false;
+            }
+            if (columns.contains(column)) {
+                keptColumns << column;
+            }
+        }
+        Columns remainingColumns;
+        foreach (ContactsTreeModel::Column column, columns) {
+            if (columns.count(column) != 1) {
+                return false;
+            }
+            if (mColumns.contains(column)) {
+                remainingColumns << column;
+            }
+        }
+        if (keptColumns.isEmpty() || keptColumns != remainingColumns) {
+            return false;
+        }
+
+        // EntityTreeModel::index() checks the column against the root's
+        // column count, so that must cover the parents still pending: the
+        // root is notified last of removals and first of insertions.
+        const QModelIndexList collections = collectionIndexes();
+        const QModelIndexList removalParents = QModelIndexList() << collections << QModelIndex();
+        const QModelIndexList insertionParents = QModelIndexList() << QModelIndex() << collections;
+
+        // remove runs of dropped columns, back to front
+        int last = mColumns.count() - 1;
+        while (last >= 0) {
+            if (columns.contains(mColumns.at(last))) {
+                --last;
+                continue;
+            }
+
+            int first = last;
+            while (first > 0 && !columns.contains(mColumns.at(first - 1))) {
+                --first;
+            }
+
+            removeColumns(removalParents, first, last);
+            last = first - 1;
+        }
+
+        // insert runs of new columns, front to back
+        int first = 0;
+        while (first < columns.count()) {
+            if (first < mColumns.count() && mColumns.at(first) == columns.at(first)) {
+                ++first;
+                continue;
+            }
+
+            int last = first;
+            while (last + 1 < columns.count() && !keptColumns.contains(columns.at(last + 1))) {
+                ++last;
+            }
+
+            insertColumns(insertionParents, first, columns.mid(first, last - first + 1));
+            first = last + 1;
+        }
+
+        return true;
+    }
+
+    ContactsTreeModel *q;
     Columns mColumns;
     const int mIconSize;
+    QCollator mCollator;
+    QList<QPersistentModelIndex> mCollectionIndexes;
+    Columns mPreviousColumns;
+    QSet<QModelIndex> mPendingParents;
+    mutable QHash<Akonadi::Item::Id, ItemData> mItemData;
+    mutable QCache<Akonadi::Item::Id, Thumbnail> mThumbnails;
+    mutable QHash<Akonadi::Item::Id, int> mPendingThumbnails;
+    mutable QThread *mThumbnailThread;
+    mutable ContactThumbnailLoader *mThumbnailLoader;
 };
 
 ContactsTreeModel::ContactsTreeModel(ChangeRecorder *monitor, QObject *parent)
     : EntityTreeModel(monitor, parent)
-    , d(new Private)
+    , d(new Private(this))
 {
+    connect(this, SIGNAL(rowsInserted(QModelIndex,int,int)),
+            this, SLOT(rowsInserted(QModelIndex,int,int)));
+    connect(this, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+            this, SLOT(rowsAboutToBeRemoved(QModelIndex,int,int)));
+    connect(this, SIGNAL(modelReset()), this, SLOT(clearItemData()));
 }
 
 ContactsTreeModel::~ContactsTreeModel()
@@ -60,9 +529,39 @@ ContactsTreeModel::~ContactsTreeModel()
 
 void ContactsTreeModel::setColumns(const Columns &columns)
 {
-    Q_EMIT beginResetModel();
-    d->mColumns = columns;
-    Q_EMIT endResetModel();
+    if (columns == d->mColumns) {
+        return;
+    }
+
+    if (!d->changeColumns(columns)) {
+        Q_EMIT beginResetModel();
+        d->mColumns = columns;
+        d->mItemData.clear();
+        Q_EMIT endResetModel();
+    }
+}
+
+int ContactsTreeModel::columnCount(const QModelIndex &parent) const
+{
+    if (!d->mPendingParents.isEmpty() && d->mPendingParents.contains(parent)) {
+        return d->mPreviousColumns.count();
+    }
+
+    // items have no children, so they are not notified of column changes
+    if (parent.isValid() && !parent.data(EntityTreeModel::CollectionRole).value<Akonadi::Collection>().isValid()) {
+        return 0;
+    }
+
+    return EntityTreeModel::columnCount(parent);
+}
+
+QVariant ContactsTreeModel::data(const QModelIndex &index, int role) const
+{
+    if (!d->mPendingParents.isEmpty() && index.isValid() && d->mPendingParents.contains(index.parent())) {
+        return d->previousData(index, role);
+    }
+
+    return EntityTreeModel::data(index, role);
 }
 
 ContactsTreeModel::Columns ContactsTreeModel::columns() const
@@ -83,81 +582,41 @@ QVariant ContactsTreeModel::entityData(const Item &item, int column, int role) c
             return QVariant();
         }
 
-        const KContacts::Addressee contact = item.payload<KContacts::Addressee>();
+        if (column >= d->mColumns.count()) {
+            // a column that is being removed, see Private::previousData()
+            return QVariant();
+        }
 
         if (role == Qt::DecorationRole) {
             if (column == 0) {
-                const KContacts::Picture picture = contact.photo();
-                if (picture.isIntern()) {
-                    return picture.data().scaled(QSize(d->mIconSize, d->mIconSize), Qt::KeepAspectRatio);
+                if (d->itemData(item).hasPhoto) {
+                    return d->photoDecoration(item);
                 } else {
                     return QIcon::fromTheme(QStringLiteral("user-identity"));
                 }
             }
             return QVariant();
         } else if ((role == Qt::DisplayRole) || (role == Qt::EditRole)) {
-            switch (d->mColumns.at(column)) {
-            case FullName:
-                if (contact.realName().isEmpty()) {
-                    if (contact.preferredEmail().isEmpty()) {
-                        return contact.familyName();
-                    }
-                    return contact.preferredEmail();
-                }
-                return contact.realName();
-            case FamilyName:
-                return contact.familyName();
-            case GivenName:
-                return contact.givenName();
-            case Birthday:
-                if (contact.birthday().date().isValid()) {
-                    return QLocale().toString(contact.birthday().date(), QLocale::ShortFormat);
-                }
-                break;
-            case HomeAddress: {
-                const KContacts::Address address = contact.address(KContacts::Address::Home);
-                if (!address.isEmpty()) {
-                    return address.formattedAddress();
-                }
-                break;
-            }
-            case BusinessAddress: {
-                const KContacts::Address address = contact.address(KContacts::Address::Work);
-                if (!address.isEmpty()) {
-                    return address.formattedAddress();
-                }
-                break;
-            }
-            case PhoneNumbers: {
-                QStringList values;
-
-                const KContacts::PhoneNumber::List numbers = contact.phoneNumbers();
-                foreach (const KContacts::PhoneNumber &number, numbers) {
-                    values += number.number();
-                }
-
-                return values.join(QStringLiteral("\n"));
-                break;
-            }
-            case PreferredEmail:
-                return contact.preferredEmail();
-            case AllEmails:
-                return contact.emails().join(QStringLiteral("\n"));
-            case Organization:
-                return contact.organization();
-            case Role:
-                return contact.role();
-            case Homepage:
-                return contact.url().url();
-            case Note:
-                return contact.note();
+            const QVariant &value = d->itemData(item).values.at(column);
+            if (value.isValid()) {
+                return value;
             }
         } else if (role == DateRole) {
             if (d->mColumns.at(column) == Birthday) {
-                return contact.birthday();
+                return d->itemData(item).birthday;
             } else {
                 return QDate();
             }
+        } else if (role == BirthdaySortRole) {
+            if (d->mColumns.at(column) == Birthday) {
+                const int packedBirthday = d->itemData(item).packedBirthday;
+                if (packedBirthday != -1) {
+                    return packedBirthday;
+                }
+            }
+            return QVariant();
+        } else if (role == CollationKeyRole) {
+            return QVariant::fromValue(d->collationKeys(item).at(column));
         }
     } else if (item.mimeType() == KContacts::ContactGroup::mimeType()) {
         if (!item.hasPayload<KContacts::ContactGroup>()) {
@@ -170,6 +629,14 @@ QVariant ContactsTreeModel::entityData(const Item &item, int column, int role) c
             return QVariant();
         }
 
+        if (column >= d->mColumns.count()) {
+            return QVariant();
+        }
+
+        if (role == CollationKeyRole) {
+            return QVariant::fromValue(d->collationKeys(item).at(column));
+        }
+
         if (role == Qt::DecorationRole) {
             if (column == 0) {
                 return QIcon::fromTheme(QStringLiteral("x-mail-distribution-list"));
@@ -177,16 +644,7 @@ QVariant ContactsTreeModel::entityData(const Item &item, int column, int role) c
                 return QVariant();
             }
         } else if ((role == Qt::DisplayRole) || (role == Qt::EditRole)) {
-            switch (d->mColumns.at(column)) {
-            case FullName: {
-                const KContacts::ContactGroup group = item.payload<KContacts::ContactGroup>();
-                return group.name();
-                break;
-            }
-            default:
-                return QVariant();
-                break;
-            }
+            return d->itemData(item).values.at(column);
         }
     }
 
@@ -234,11 +692,13 @@ QVariant ContactsTreeModel::entityHeaderData(int section, Qt::Orientation orient
                     break;
                 }
             } else if (headerGroup == EntityTreeModel::ItemListHeaders) {
-                if (section < 0 || section >= d->mColumns.count()) {
+                // the headers belong to the root, see Private::removeColumns()
+                const Columns &columns = d->mPendingParents.contains(QModelIndex()) ? d->mPreviousColumns : d->mColumns;
+                if (section < 0 || section >= columns.count()) {
                     return QVariant();
                 }
 
-                switch (d->mColumns.at(section)) {
+                switch (columns.at(section)) {
                 case FullName:
                     return i18nc("@title:column name of a person", "Name");
                 case FamilyName:
@@ -272,3 +732,5 @@ QVariant ContactsTreeModel::entityHeaderData(int section, Qt::Orientation orient
 
     return EntityTreeModel::entityHeaderData(section, orientation, role, headerGroup);
 }
+
+#include "moc_contactstreemodel.cpp"
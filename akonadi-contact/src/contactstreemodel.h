@@ -179,6 +179,9 @@ public:
 
     /**
      * Sets the @p columns that the model should show.
+     *
+     * Adding or removing columns is signaled as column insertions and
+     * removals; only reordering the columns resets the model.
      */
     void setColumns(const Columns &columns);
 
@@ -192,12 +195,19 @@ public:
     QVariant entityData(const Collection &collection, int column, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
     QVariant entityHeaderData(int section, Qt::Orientation orientation, int role, HeaderGroup headerGroup) const Q_DECL_OVERRIDE;
     int entityColumnCount(HeaderGroup headerGroup) const Q_DECL_OVERRIDE;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
     //@endcond
 
 private:
     //@cond PRIVATE
     class Private;
     Private *const d;
+
+    Q_PRIVATE_SLOT(d, void thumbnailLoaded(qint64, int, const QImage &))
+    Q_PRIVATE_SLOT(d, void rowsInserted(const QModelIndex &, int, int))
+    Q_PRIVATE_SLOT(d, void rowsAboutToBeRemoved(const QModelIndex &, int, int))
+    Q_PRIVATE_SLOT(d, void clearItemData())
     //@endcond
 };
 
@@ -0,0 +1,79 @@
+/*
+    This file is part of Akonadi Contact.
+
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef AKONADI_CONTACTSTREEMODEL_P_H
+#define AKONADI_CONTACTSTREEMODEL_P_H
+
+#include "contactstreemodel.h"
+
+#include <QtCore/QCollatorSortKey>
+#include <QtCore/QMetaType>
+#include <QtCore/QSharedPointer>
+
+namespace Akonadi
+{
+
+/**
+ * @internal
+ *
+ * Roles provided by ContactsTreeModel for sorting in ContactsFilterProxyModel.
+ * They are kept clear of the roles of EmailAddressSelectionProxyModel.
+ */
+enum ContactsTreeModelSortRole {
+    BirthdaySortRole = ContactsTreeModel::DateRole + 10, ///< The month and day of the birthday packed into an int.
+    CollationKeyRole                                     ///< The ContactCollationKey of the display text.
+};
+
+/**
+ * @internal
+ *
+ * A default constructible, cheaply copyable wrapper around QCollatorSortKey,
+ * so that collation keys can be cached and passed around in a QVariant.
+ */
+class ContactCollationKey
+{
+public:
+    ContactCollationKey()
+    {
+    }
+
+    explicit ContactCollationKey(const QCollatorSortKey &key)
+        : mKey(new QCollatorSortKey(key))
+    {
+    }
+
+    bool isValid() const
+    {
+        return !mKey.isNull();
+    }
+
+    int compare(const ContactCollationKey &other) const
+    {
+        return mKey->compare(*other.mKey);
+    }
+
+private:
+    QSharedPointer<QCollatorSortKey> mKey;
+};
+
+}
+
+Q_DECLARE_METATYPE(Akonadi::ContactCollationKey)
+
+#endif
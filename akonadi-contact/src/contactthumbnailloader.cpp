@@ -0,0 +1,85 @@
+/*
+    This file is part of Akonadi Contact.
+
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "contactthumbnailloader_p.h"
+
+#include <QtCore/QMutexLocker>
+
+using namespace Akonadi;
+
+ContactThumbnailLoader::ContactThumbnailLoader(QObject *parent)
+    : QObject(parent)
+    , mCancelled(0)
+{
+}
+
+void ContactThumbnailLoader::request(Item::Id id, int revision, const QByteArray &rawData, const QImage &image, int size)
+{
+    Request request;
+    request.id = id;
+    request.revision = revision;
+    request.rawData = rawData;
+    request.image = image;
+    request.size = size;
+
+    QMutexLocker locker(&mMutex);
+    if (mCancelled.loadAcquire()) {
+        return;
+    }
+    const bool wasIdle = mRequests.isEmpty();
+    mRequests.append(request);
+    locker.unlock();
+
+    if (wasIdle) {
+        QMetaObject::invokeMethod(this, "processRequests", Qt::QueuedConnection);
+    }
+}
+
+void ContactThumbnailLoader::cancel()
+{
+    QMutexLocker locker(&mMutex);
+    mRequests.clear();
+    mCancelled.storeRelease(1);
+}
+
+void ContactThumbnailLoader::processRequests()
+{
+    QMutexLocker locker(&mMutex);
+    QList<Request> requests;
+    requests.swap(mRequests);
+    locker.unlock();
+
+    foreach (const Request &request, requests) {
+        if (mCancelled.loadAcquire()) {
+            return;
+        }
+
+        QImage image = request.image;
+        if (!request.rawData.isEmpty()) {
+            image = QImage::fromData(request.rawData);
+        }
+
+        QImage thumbnail;
+        if (!image.isNull()) {
+            thumbnail = image.scaled(QSize(request.size, request.size), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+
+        Q_EMIT thumbnailLoaded(request.id, request.revision, thumbnail);
+    }
+}
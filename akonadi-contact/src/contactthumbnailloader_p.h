@@ -0,0 +1,88 @@
+/*
+    This file is part of Akonadi Contact.
+
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef AKONADI_CONTACTTHUMBNAILLOADER_P_H
+#define AKONADI_CONTACTTHUMBNAILLOADER_P_H
+
+#include <item.h>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtGui/QImage>
+
+namespace Akonadi
+{
+
+/**
+ * @internal
+ *
+ * Decodes contact photos and scales them to thumbnails on a worker thread
+ * for ContactsTreeModel.
+ */
+class ContactThumbnailLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ContactThumbnailLoader(QObject *parent = Q_NULLPTR);
+
+    /**
+     * Requests a thumbnail of @p size pixels for the photo of the given
+     * revision of an item. The photo is passed either as encoded @p rawData,
+     * or, if that is empty, as decoded @p image. Can be called from any thread.
+     */
+    void request(Akonadi::Item::Id id, int revision, const QByteArray &rawData, const QImage &image, int size);
+
+    /**
+     * Drops the pending requests and stops decoding the current ones, for
+     * shutting the loader down. Later requests are ignored.
+     * Can be called from any thread.
+     */
+    void cancel();
+
+Q_SIGNALS:
+    /**
+     * Emitted when the thumbnail for the given revision of an item is
+     * available. @p thumbnail is null if the photo could not be decoded.
+     */
+    void thumbnailLoaded(qint64 id, int revision, const QImage &thumbnail);
+
+private Q_SLOTS:
+    void processRequests();
+
+private:
+    struct Request {
+        Akonadi::Item::Id id;
+        int revision;
+        QByteArray rawData;
+        QImage image;
+        int size;
+    };
+
+    QMutex mMutex;
+    QList<Request> mRequests;
+    QAtomicInt mCancelled;
+};
+
+}
+
+#endif
@@ -57,7 +57,8 @@ QString StandardContactGroupFormatter::toHtml(HtmlForm form) const
         // we got a contact group with unresolved references -> we have to resolve it ourself
         // this shouldn't be the normal case, actually the calling code should pass in an already resolved
         // contact group
-        ContactGroupExpandJob *job = new ContactGroupExpandJob(group);
+        ContactGroupExpandJob *job = localItem.hasPayload<KContacts::ContactGroup>() ? new ContactGroupExpandJob(localItem)
+                                                                                   : new ContactGroupExpandJob(group);
         if (job->exec()) {
             group.removeAllContactData();
             foreach (const KContacts::Addressee &contact, job->contacts()) {
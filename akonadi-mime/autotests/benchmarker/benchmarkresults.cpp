@@ -0,0 +1,116 @@
+/*
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "benchmarkresults.h"
+
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVector>
+
+#include <algorithm>
+
+Q_GLOBAL_STATIC(BenchmarkResults, sResults)
+
+BenchmarkResults *BenchmarkResults::self()
+{
+    return sResults;
+}
+
+void BenchmarkResults::addSample(const QString &suite, const QString &name, double msecs, qint64 items)
+{
+    const QPair<QString, QString> key(suite, name);
+    if (!mSamples.contains(key)) {
+        mOrder.append(key);
+    }
+    const Sample sample = { msecs, items };
+    mSamples[key].append(sample);
+}
+
+void BenchmarkResults::setParameter(const QString &key, const QString &value)
+{
+    mParameters.insert(key, value);
+}
+
+// Nearest-rank percentile of the sorted values
+static double percentile(const QVector<double> &sorted, int percent)
+{
+    if (sorted.isEmpty()) {
+        return 0;
+    }
+    const int rank = qMax(1, (percent * sorted.size() + 99) / 100);
+    return sorted.at(rank - 1);
+}
+
+static double median(const QVector<double> &sorted)
+{
+    if (sorted.isEmpty()) {
+        return 0;
+    }
+    const int middle = sorted.size() / 2;
+    if (sorted.size() % 2) {
+        return sorted.at(middle);
+    }
+    return (sorted.at(middle - 1) + sorted.at(middle)) / 2;
+}
+
+bool BenchmarkResults::writeJson(QIODevice *device) const
+{
+    QJsonObject parameters;
+    QMap<QString, QString>::const_iterator it = mParameters.constBegin();
+    for (; it != mParameters.constEnd(); ++it) {
+        parameters.insert(it.key(), it.value());
+    }
+
+    QJsonArray benchmarks;
+    typedef QPair<QString, QString> Key;
+    foreach (const Key &key, mOrder) {
+        const QList<Sample> samples = mSamples.value(key);
+
+        QVector<double> msecs;
+        QJsonArray rawSamples;
+        qint64 items = 0;
+        foreach (const Sample &sample, samples) {
+            msecs.append(sample.msecs);
+            rawSamples.append(sample.msecs);
+            items = qMax(items, sample.items);
+        }
+        std::sort(msecs.begin(), msecs.end());
+
+        const double medianMsecs = median(msecs);
+
+        QJsonObject benchmark;
+        benchmark.insert(QStringLiteral("suite"), key.first);
+        benchmark.insert(QStringLiteral("name"), key.second);
+        benchmark.insert(QStringLiteral("runs"), samples.count());
+        benchmark.insert(QStringLiteral("items"), double(items));
+        benchmark.insert(QStringLiteral("median_ms"), medianMsecs);
+        benchmark.insert(QStringLiteral("p95_ms"), percentile(msecs, 95));
+        benchmark.insert(QStringLiteral("min_ms"), msecs.isEmpty() ? 0 : msecs.first());
+        benchmark.insert(QStringLiteral("max_ms"), msecs.isEmpty() ? 0 : msecs.last());
+        benchmark.insert(QStringLiteral("items_per_s"), medianMsecs > 0 ? items * 1000.0 / medianMsecs : 0);
+        benchmark.insert(QStringLiteral("samples_ms"), rawSamples);
+        benchmarks.append(benchmark);
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("parameters"), parameters);
+    root.insert(QStringLiteral("benchmarks"), benchmarks);
+
+    return device->write(QJsonDocument(root).toJson()) >= 0;
+}
@@ -0,0 +1,70 @@
+/*
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef BENCHMARKRESULTS_H
+#define BENCHMARKRESULTS_H
+
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QPair>
+#include <QtCore/QString>
+
+class QIODevice;
+
+/**
+  Collects the timings of all benchmark runs and writes them out as JSON.
+
+  Every call of addSample() records one repetition of a benchmark. For every
+  benchmark the median, 95th percentile, minimum and maximum of the samples
+  are reported, together with the throughput in items per second based on
+  the median.
+*/
+class BenchmarkResults
+{
+public:
+    static BenchmarkResults *self();
+
+    /**
+      Records one run of the benchmark @p name of the @p suite which took
+      @p msecs milliseconds and processed @p items items.
+    */
+    void addSample(const QString &suite, const QString &name, double msecs, qint64 items);
+
+    /**
+      Sets a free-form parameter describing the run, e.g. the number of
+      generated messages, which is written along with the results.
+    */
+    void setParameter(const QString &key, const QString &value);
+
+    /**
+      Writes the collected results as JSON document to @p device.
+    */
+    bool writeJson(QIODevice *device) const;
+
+private:
+    struct Sample {
+        double msecs;
+        qint64 items;
+    };
+
+    // (suite, name) -> samples, in insertion order of the benchmarks
+    QList<QPair<QString, QString> > mOrder;
+    QMap<QPair<QString, QString>, QList<Sample> > mSamples;
+    QMap<QString, QString> mParameters;
+};
+
+#endif
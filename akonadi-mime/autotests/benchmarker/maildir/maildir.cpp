@@ -30,18 +30,163 @@
 #include <kmime/kmime_message.h>
 #include "akonadi/kmime/messageparts.h"
 
+#include <QDebug>
+
 #define WAIT_TIME 100
 
 using namespace Akonadi;
 
 MailDir::MailDir(const QString &dir)
     : MakeTest()
+    , mDir(dir)
+    , mReadOnly(true)
+    , mPendingSet(false)
+    , mPendingDelete(false)
 {
-    createAgent(QStringLiteral("akonadi_maildir_resource"));
-    configureDBusIface(QStringLiteral("Maildir"), dir);
 }
 
 MailDir::MailDir()
     : MakeTest()
+    , mReadOnly(true)
+    , mPendingSet(false)
+    , mPendingDelete(false)
+{
+}
+
+void MailDir::setReadOnly(bool readOnly)
+{
+    mReadOnly = readOnly;
+}
+
+void MailDir::createResource()
+{
+    prepareWait(ResourceIdle);
+    createAgent(QStringLiteral("akonadi_maildir_resource"));
+    configureDBusIface(QStringLiteral("Maildir"), mDir, mReadOnly);
+    // wait for the resource to come up before measuring anything
+    waitForDone();
+}
+
+static Akonadi::Item withFlag(const Akonadi::Item &item, const QByteArray &flag, bool set)
+{
+    Akonadi::Item modified(item);
+    if (set) {
+        modified.setFlag(flag);
+    } else {
+        modified.clearFlag(flag);
+    }
+    return modified;
+}
+
+void MailDir::modifyItems(const Item::List &items, const QByteArray &flag, bool set,
+                          Strategy strategy, int count)
+{
+    switch (strategy) {
+    case PerItem:
+        foreach (const Item &item, items) {
+            ItemModifyJob *job = new ItemModifyJob(withFlag(item, flag, set), this);
+            job->exec();
+        }
+        break;
+    case Batch:
+        for (int i = 0; i < items.count(); i += count) {
+            Item::List batch;
+            foreach (const Item &item, items.mid(i, count)) {
+                batch.append(withFlag(item, flag, set));
+            }
+            ItemModifyJob *job = new ItemModifyJob(batch, this);
+            job->setIgnorePayload(true);
+            job->disableRevisionCheck();
+            job->exec();
+        }
+        break;
+    case InFlight:
+        // jobs of an earlier run which timed out are not waited for
+        mRunningJobs.clear();
+        mPendingItems = items;
+        mPendingFlag = flag;
+        mPendingSet = set;
+        mPendingDelete = false;
+        if (items.isEmpty()) {
+            break;
+        }
+        prepareWait(Finished);
+        for (int i = 0; i < count && !mPendingItems.isEmpty(); ++i) {
+            startInFlightJob();
+        }
+        waitForDone();
+        break;
+    }
+}
+
+void MailDir::deleteItems(const Item::List &items, Strategy strategy, int count)
+{
+    switch (strategy) {
+    case PerItem:
+        foreach (const Item &item, items) {
+            ItemDeleteJob *job = new ItemDeleteJob(item, this);
+            job->exec();
+        }
+        break;
+    case Batch:
+        for (int i = 0; i < items.count(); i += count) {
+            ItemDeleteJob *job = new ItemDeleteJob(items.mid(i, count), this);
+            job->exec();
+        }
+        break;
+    case InFlight:
+        mRunningJobs.clear();
+        mPendingItems = items;
+        mPendingDelete = true;
+        if (items.isEmpty()) {
+            break;
+        }
+        prepareWait(Finished);
+        for (int i = 0; i < count && !mPendingItems.isEmpty(); ++i) {
+            startInFlightJob();
+        }
+        waitForDone();
+        break;
+    }
+}
+
+void MailDir::startInFlightJob()
+{
+    const Item item = mPendingItems.takeFirst();
+    KJob *job = Q_NULLPTR;
+    if (mPendingDelete) {
+        job = new ItemDeleteJob(item, this);
+    } else {
+        job = new ItemModifyJob(withFlag(item, mPendingFlag, mPendingSet), this);
+    }
+    connect(job, &KJob::result, this, &MailDir::inFlightJobDone);
+    mRunningJobs.insert(job);
+}
+
+void MailDir::inFlightJobDone(KJob *job)
+{
+    if (!mRunningJobs.remove(job)) {
+        return;
+    }
+    if (job->error()) {
+        qWarning() << "  Job failed:" << job->errorString();
+    }
+    if (!mPendingItems.isEmpty()) {
+        startInFlightJob();
+    } else if (mRunningJobs.isEmpty()) {
+        finish();
+    }
+}
+
+QString MailDir::strategySuffix(Strategy strategy, int count)
 {
+    switch (strategy) {
+    case Batch:
+        return QStringLiteral("-batch%1").arg(count);
+    case InFlight:
+        return QStringLiteral("-inflight%1").arg(count);
+    case PerItem:
+    default:
+        return QString();
+    }
 }
@@ -23,12 +23,71 @@
 
 #include "../maketest.h"
 
+#include <item.h>
+
+#include <QSet>
+
+class KJob;
+
 class MailDir : public MakeTest
 {
+    Q_OBJECT
 
 public:
+    /**
+      How modifications of many items are sent to the server.
+    */
+    enum Strategy {
+        PerItem,    ///< one synchronous job per item
+        Batch,      ///< one synchronous job per batch of items
+        InFlight    ///< one job per item, with several jobs running concurrently
+    };
+
     MailDir(const QString &dir);
     MailDir();
+
+    /**
+      Sets whether the resource created for the maildir may modify it,
+      default is read-only.
+    */
+    void setReadOnly(bool readOnly);
+
+protected:
+    void createResource();
+
+    /**
+      Sets @p flag on all @p items (or clears it if @p set is false) using
+      the given @p strategy. @p count is the batch size or the number of
+      concurrent jobs.
+    */
+    void modifyItems(const Akonadi::Item::List &items, const QByteArray &flag, bool set,
+                     Strategy strategy, int count);
+
+    /**
+      Deletes @p items using the given @p strategy, see modifyItems().
+    */
+    void deleteItems(const Akonadi::Item::List &items, Strategy strategy, int count);
+
+    /**
+      Returns the suffix added to the benchmark name for @p strategy,
+      empty for PerItem.
+    */
+    static QString strategySuffix(Strategy strategy, int count);
+
+    QString mDir;
+    bool mReadOnly;
+
+private Q_SLOTS:
+    void inFlightJobDone(KJob *job);
+
+private:
+    void startInFlightJob();
+
+    Akonadi::Item::List mPendingItems;
+    QByteArray mPendingFlag;
+    bool mPendingSet;
+    bool mPendingDelete;
+    QSet<KJob *> mRunningJobs;
 };
 
 #endif
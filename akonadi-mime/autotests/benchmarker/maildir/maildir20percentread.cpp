@@ -30,29 +30,41 @@
 
 using namespace Akonadi;
 
-MailDir20PercentAsRead::MailDir20PercentAsRead()
+MailDir20PercentAsRead::MailDir20PercentAsRead(Strategy strategy, int count)
     : MailDir()
+    , mStrategy(strategy)
+    , mCount(count)
 {
 }
 
 void MailDir20PercentAsRead::runTest()
 {
-    timer.start();
-    qDebug() << "  Marking 20% of messages as read.";
     CollectionFetchJob *clj2 = new CollectionFetchJob(Collection::root(), CollectionFetchJob::Recursive);
     clj2->fetchScope().setResource(currentInstance.identifier());
     clj2->exec();
     Collection::List list2 = clj2->collections();
+    Item::List toModify;
+    Item::List alreadySeen;
     foreach (const Collection &collection, list2) {
         ItemFetchJob *ifj = new ItemFetchJob(collection, this);
         ifj->exec();
         Item::List itemlist = ifj->items();
         for (int i = ifj->items().count() - 1; i >= 0; i -= 5) {
-            Item item = itemlist[i];
-            item.setFlag("\\SEEN");
-            ItemModifyJob *isj = new ItemModifyJob(item, this);
-            isj->exec();
+            toModify.append(itemlist[i]);
+            if (itemlist[i].hasFlag("\\SEEN")) {
+                alreadySeen.append(itemlist[i]);
+            }
         }
     }
-    outputStats(QStringLiteral("mark20percentread"));
+
+    // Earlier variants may have marked the messages already, reset them so
+    // that every variant has to do the same work.
+    if (!alreadySeen.isEmpty()) {
+        modifyItems(alreadySeen, "\\SEEN", false, Batch, 1000);
+    }
+
+    timer.start();
+    qDebug() << "  Marking 20% of messages as read" << strategySuffix(mStrategy, mCount);
+    modifyItems(toModify, "\\SEEN", true, mStrategy, mCount);
+    outputStats(QStringLiteral("mark20percentread") + strategySuffix(mStrategy, mCount), toModify.count());
 }
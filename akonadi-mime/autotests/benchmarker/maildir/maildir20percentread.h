@@ -27,7 +27,11 @@ class MailDir20PercentAsRead : public MailDir
 {
 
 public:
-    MailDir20PercentAsRead();
+    explicit MailDir20PercentAsRead(Strategy strategy = PerItem, int count = 1);
     void runTest() Q_DECL_OVERRIDE;
+
+private:
+    Strategy mStrategy;
+    int mCount;
 };
 #endif
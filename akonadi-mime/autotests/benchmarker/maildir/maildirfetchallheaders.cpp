@@ -46,6 +46,7 @@ void MailDirFetchAllHeaders::runTest()
     clj->fetchScope().setResource(currentInstance.identifier());
     clj->exec();
     Collection::List list = clj->collections();
+    qint64 items = 0;
     foreach (const Collection &collection, list) {
         ItemFetchJob *ifj = new ItemFetchJob(collection, this);
         ifj->fetchScope().fetchPayloadPart(MessagePart::Envelope);
@@ -54,6 +55,7 @@ void MailDirFetchAllHeaders::runTest()
         foreach (const Item &item, ifj->items()) {
             a = item.payload<KMime::Message::Ptr>()->subject()->asUnicodeString();
         }
+        items += ifj->items().count();
     }
-    outputStats(QStringLiteral("fullheaderlist"));
+    outputStats(QStringLiteral("fullheaderlist"), items);
 }
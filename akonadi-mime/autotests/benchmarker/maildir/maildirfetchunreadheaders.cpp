@@ -46,6 +46,7 @@ void MailDirFetchUnreadHeaders::runTest()
     clj3->fetchScope().setResource(currentInstance.identifier());
     clj3->exec();
     Collection::List list3 = clj3->collections();
+    qint64 items = 0;
     foreach (const Collection &collection, list3) {
         ItemFetchJob *ifj = new ItemFetchJob(collection, this);
         ifj->fetchScope().fetchPayloadPart(MessagePart::Envelope);
@@ -57,6 +58,7 @@ void MailDirFetchUnreadHeaders::runTest()
                 a = item.payload<KMime::Message::Ptr>()->subject()->asUnicodeString();
             }
         }
+        items += ifj->items().count();
     }
-    outputStats(QStringLiteral("unreadheaderlist"));
+    outputStats(QStringLiteral("unreadheaderlist"), items);
 }
@@ -0,0 +1,139 @@
+/*
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "maildirgenerator.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+
+MailDirGenerator::MailDirGenerator()
+    : mFolderCount(1)
+    , mMessagesPerFolder(1000)
+    , mBodySize(2048)
+    , mSeenPercentage(50)
+    , mDuplicatePercentage(0)
+{
+}
+
+void MailDirGenerator::setFolderCount(int count)
+{
+    mFolderCount = qMax(1, count);
+}
+
+void MailDirGenerator::setMessagesPerFolder(int count)
+{
+    mMessagesPerFolder = qMax(0, count);
+}
+
+void MailDirGenerator::setBodySize(int size)
+{
+    mBodySize = qMax(0, size);
+}
+
+void MailDirGenerator::setSeenPercentage(int percent)
+{
+    mSeenPercentage = qBound(0, percent, 100);
+}
+
+void MailDirGenerator::setDuplicatePercentage(int percent)
+{
+    mDuplicatePercentage = qBound(0, percent, 100);
+}
+
+int MailDirGenerator::messageCount() const
+{
+    return mFolderCount * mMessagesPerFolder;
+}
+
+bool MailDirGenerator::generate(const QString &path) const
+{
+    QDir dir;
+    if (!dir.mkpath(path)) {
+        qWarning() << "Unable to create" << path;
+        return false;
+    }
+
+    // The top-level maildir acts as container, the messages live in the
+    // subfolders so that the per-folder fetch benchmarks have some work.
+    foreach (const QString &sub, QStringList() << QStringLiteral("cur") << QStringLiteral("new") << QStringLiteral("tmp")) {
+        dir.mkpath(path + QLatin1Char('/') + sub);
+    }
+
+    for (int folder = 0; folder < mFolderCount; ++folder) {
+        if (!generateFolder(path + QStringLiteral("/folder%1").arg(folder), folder)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MailDirGenerator::generateFolder(const QString &path, int folder) const
+{
+    QDir dir;
+    foreach (const QString &sub, QStringList() << QStringLiteral("cur") << QStringLiteral("new") << QStringLiteral("tmp")) {
+        if (!dir.mkpath(path + QLatin1Char('/') + sub)) {
+            qWarning() << "Unable to create" << path;
+            return false;
+        }
+    }
+
+    QByteArray bodyLine("Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod.\n");
+    QByteArray body;
+    body.reserve(mBodySize + bodyLine.size());
+    while (body.size() < mBodySize) {
+        body += bodyLine;
+    }
+
+    int content = -1;
+    for (int i = 0; i < mMessagesPerFolder; ++i) {
+        const int number = folder * mMessagesPerFolder + i;
+
+        // A duplicate repeats the content (including the Message-ID) of
+        // the message before it.
+        const bool duplicate = i > 0 && ((number * 53) % 100) < mDuplicatePercentage;
+        if (!duplicate) {
+            content = number;
+        }
+
+        // Spread the seen messages evenly instead of putting them in one block.
+        const bool seen = ((number * 37) % 100) < mSeenPercentage;
+        const QString fileName = QStringLiteral("%1/cur/%2.benchmark.%3:2,%4")
+                                 .arg(path)
+                                 .arg(1262304000 + number)
+                                 .arg(number)
+                                 .arg(seen ? QStringLiteral("S") : QString());
+
+        QByteArray message;
+        message += "From: Sender " + QByteArray::number(content % 97) + " <sender" + QByteArray::number(content % 97) + "@example.org>\n";
+        message += "To: Receiver <receiver@example.org>\n";
+        message += "Subject: Benchmark message " + QByteArray::number(content) + "\n";
+        message += "Date: Fri, 01 Jan 2010 00:00:00 +0000\n";
+        message += "Message-ID: <" + QByteArray::number(content) + ".benchmark@example.org>\n";
+        message += "MIME-Version: 1.0\n";
+        message += "Content-Type: text/plain; charset=\"us-ascii\"\n";
+        message += "\n";
+        message += body;
+
+        QFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly) || file.write(message) != message.size()) {
+            qWarning() << "Unable to write" << fileName;
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,71 @@
+/*
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef MAILDIRGENERATOR_H
+#define MAILDIRGENERATOR_H
+
+#include <QtCore/QString>
+
+/**
+  Writes a synthetic maildir to be used as data source for the benchmarks.
+
+  The generated content only depends on the parameters, so runs with the
+  same settings operate on identical data.
+*/
+class MailDirGenerator
+{
+public:
+    MailDirGenerator();
+
+    /** The number of folders below the top-level maildir, default 1. */
+    void setFolderCount(int count);
+
+    /** The number of messages per folder, default 1000. */
+    void setMessagesPerFolder(int count);
+
+    /** The approximate body size of every message in bytes, default 2048. */
+    void setBodySize(int size);
+
+    /** The percentage of messages which are flagged as seen, default 50. */
+    void setSeenPercentage(int percent);
+
+    /**
+      The percentage of messages which are exact duplicates of the previous
+      message in the same folder, default 0.
+    */
+    void setDuplicatePercentage(int percent);
+
+    /**
+      Writes the maildir to @p path, which must be an empty or non-existing
+      directory. Returns false on error.
+    */
+    bool generate(const QString &path) const;
+
+    /** Returns the total number of messages generate() writes. */
+    int messageCount() const;
+
+private:
+    bool generateFolder(const QString &path, int folder) const;
+
+    int mFolderCount;
+    int mMessagesPerFolder;
+    int mBodySize;
+    int mSeenPercentage;
+    int mDuplicatePercentage;
+};
+
+#endif
@@ -21,23 +21,60 @@
 #include "maildirimport.h"
 #include "maildir.h"
 #include <QDebug>
-#include <QTest>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
 
-#define WAIT_TIME 100
+static bool copyDirectory(const QString &source, const QString &target)
+{
+    if (!QDir().mkpath(target)) {
+        return false;
+    }
+
+    const QFileInfoList entries = QDir(source).entryInfoList(QDir::Files | QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot);
+    foreach (const QFileInfo &entry, entries) {
+        const QString targetPath = target + QLatin1Char('/') + entry.fileName();
+        if (entry.isDir()) {
+            if (!copyDirectory(entry.filePath(), targetPath)) {
+                return false;
+            }
+        } else if (!QFile::copy(entry.filePath(), targetPath)) {
+            return false;
+        }
+    }
+    return true;
+}
 
 MailDirImport::MailDirImport(const QString &dir)
     : MailDir(dir)
+    , mSourceDir(dir)
+{
+}
+
+MailDirImport::~MailDirImport()
 {
 }
 
 void MailDirImport::runTest()
 {
-    done = false;
+    if (!mReadOnly) {
+        // the copy of the previous repetition is not used anymore, its
+        // resource has been removed
+        mWorkDir.reset(new QTemporaryDir);
+        mDir = mWorkDir->path() + QLatin1String("/maildir");
+        if (!mWorkDir->isValid() || !copyDirectory(mSourceDir, mDir)) {
+            qFatal("Unable to copy maildir %s", qPrintable(mSourceDir));
+        }
+    }
+
+    createResource();
+
+    prepareWait(ResourceIdle);
     timer.start();
     qDebug() << "  Synchronising resource.";
     currentInstance.synchronize();
-    while (!done) {
-        QTest::qWait(WAIT_TIME);
-    }
-    outputStats(QStringLiteral("import"));
+    waitForDone();
+    const qint64 elapsed = timer.nsecsElapsed();
+    const qint64 items = countItems();
+    outputStats(QStringLiteral("import"), items, elapsed);
 }
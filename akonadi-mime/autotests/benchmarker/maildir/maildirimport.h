@@ -23,11 +23,27 @@
 
 #include "maildir.h"
 
+#include <QScopedPointer>
+
+class QTemporaryDir;
+
+/**
+  Creates a maildir resource for the given directory and imports it.
+
+  Unless the resource is read-only, the directory is copied to a temporary
+  location first, and the copy is imported. As the tests following the
+  import modify the maildir, this gives every repetition the same data.
+*/
 class MailDirImport : public MailDir
 {
 
 public:
     MailDirImport(const QString &dir);
+    ~MailDirImport();
     void runTest() Q_DECL_OVERRIDE;
+
+private:
+    QString mSourceDir;
+    QScopedPointer<QTemporaryDir> mWorkDir;
 };
 #endif
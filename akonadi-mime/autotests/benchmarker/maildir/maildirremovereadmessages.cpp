@@ -29,30 +29,35 @@
 
 using namespace Akonadi;
 
-MailDirRemoveReadMessages::MailDirRemoveReadMessages()
+MailDirRemoveReadMessages::MailDirRemoveReadMessages(Strategy strategy, int count, int part, int parts)
     : MailDir()
+    , mStrategy(strategy)
+    , mCount(count)
+    , mPart(part)
+    , mParts(qMax(1, parts))
 {
 }
 
 void MailDirRemoveReadMessages::runTest()
 {
-    timer.start();
-    qDebug() << "  Removing read messages from every folder.";
+    qDebug() << "  Removing read messages from every folder" << strategySuffix(mStrategy, mCount);
     CollectionFetchJob *clj4 = new CollectionFetchJob(Collection::root(), CollectionFetchJob::Recursive);
     clj4->fetchScope().setResource(currentInstance.identifier());
     clj4->exec();
     Collection::List list4 = clj4->collections();
+    Item::List toDelete;
     foreach (const Collection &collection, list4) {
         ItemFetchJob *ifj = new ItemFetchJob(collection, this);
         ifj->exec();
         foreach (const Item &item, ifj->items()) {
-            // delete read messages
-            if (item.hasFlag("\\SEEN")) {
-                ItemDeleteJob *idj = new ItemDeleteJob(item, this);
-                idj->exec();
+            // Delete read messages. The part is chosen by the item id, which
+            // does not depend on what earlier variants removed already.
+            if (item.hasFlag("\\SEEN") && (item.id() % mParts) == mPart) {
+                toDelete.append(item);
             }
         }
     }
-    outputStats(QStringLiteral("removereaditems"));
-
+    timer.start();
+    deleteItems(toDelete, mStrategy, mCount);
+    outputStats(QStringLiteral("removereaditems") + strategySuffix(mStrategy, mCount), toDelete.count());
 }
@@ -27,7 +27,20 @@ class MailDirRemoveReadMessages : public MailDir
 {
 
 public:
-    MailDirRemoveReadMessages();
+    /**
+      Removes the read messages using @p strategy. If @p parts is larger
+      than one, only the read messages whose item id modulo @p parts is
+      @p part are removed, so that several variants can each remove a
+      disjoint share of the same data.
+    */
+    explicit MailDirRemoveReadMessages(Strategy strategy = PerItem, int count = 1,
+                                       int part = 0, int parts = 1);
     void runTest() Q_DECL_OVERRIDE;
+
+private:
+    Strategy mStrategy;
+    int mCount;
+    int mPart;
+    int mParts;
 };
 #endif
@@ -20,12 +20,18 @@
 
 #include "testmaildir.h"
 #include "testvcard.h"
+#include "testmime.h"
+#include "benchmarkresults.h"
+#include "maildir/maildirgenerator.h"
 
 #include <QApplication>
 #include <KAboutData>
 #include <KLocalizedString>
 #include <QCommandLineParser>
 #include <QCommandLineOption>
+#include <QDebug>
+#include <QFile>
+#include <QTemporaryDir>
 
 int main(int argc, char *argv[])
 {
@@ -38,19 +44,80 @@ int main(int argc, char *argv[])
     parser.addHelpOption();
     parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("maildir"), i18n("Path to maildir to be used as data source"), QStringLiteral("argument")));
     parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("vcarddir"), i18n("Path to vvcarddir to be used as data source"), QStringLiteral("argument")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("generate-maildir"), i18n("Generate a synthetic maildir with the given number of messages per folder as data source"), QStringLiteral("count")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("folders"), i18n("Number of folders of the generated maildir"), QStringLiteral("count"), QStringLiteral("1")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("message-size"), i18n("Body size in bytes of the generated messages"), QStringLiteral("bytes"), QStringLiteral("2048")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("repeat"), i18n("Number of times every benchmark is run"), QStringLiteral("count"), QStringLiteral("5")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("library-sizes"), i18n("Run the akonadi-mime library benchmarks on generated maildirs of the given comma-separated sizes, e.g. 1000,10000,100000"), QStringLiteral("sizes")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("json"), i18n("Write the results as JSON to the given file instead of stdout"), QStringLiteral("file")));
 
     aboutData.setupCommandLine(&parser);
     parser.process(app);
     aboutData.processCommandLine(&parser);
 
-    const QString maildir = parser.value(QStringLiteral("maildir"));
+    QString maildir = parser.value(QStringLiteral("maildir"));
     const QString vcarddir = parser.value(QStringLiteral("vcarddir"));
+    const int repetitions = qMax(1, parser.value(QStringLiteral("repeat")).toInt());
 
-    TestMailDir *mailDirTest = new TestMailDir(maildir);
-    TestVCard *vcardTest = new TestVCard(vcarddir);
+    BenchmarkResults *results = BenchmarkResults::self();
+    results->setParameter(QStringLiteral("repeat"), QString::number(repetitions));
 
-    mailDirTest->runTests();
-    vcardTest->runTests();
+    QTemporaryDir generatedDir;
+    if (parser.isSet(QStringLiteral("generate-maildir"))) {
+        MailDirGenerator generator;
+        generator.setMessagesPerFolder(parser.value(QStringLiteral("generate-maildir")).toInt());
+        generator.setFolderCount(parser.value(QStringLiteral("folders")).toInt());
+        generator.setBodySize(parser.value(QStringLiteral("message-size")).toInt());
+        maildir = generatedDir.path() + QLatin1String("/maildir");
+        if (!generatedDir.isValid() || !generator.generate(maildir)) {
+            qCritical() << "Unable to generate maildir";
+            return 1;
+        }
+        results->setParameter(QStringLiteral("messages"), QString::number(generator.messageCount()));
+        results->setParameter(QStringLiteral("folders"), parser.value(QStringLiteral("folders")));
+        results->setParameter(QStringLiteral("message-size"), parser.value(QStringLiteral("message-size")));
+    }
 
-    return app.exec();
+    if (!maildir.isEmpty()) {
+        // only the generated maildir may be modified
+        TestMailDir mailDirTest(maildir, !parser.isSet(QStringLiteral("generate-maildir")));
+        mailDirTest.runTests(repetitions);
+    }
+    if (!vcarddir.isEmpty()) {
+        TestVCard vcardTest(vcarddir);
+        vcardTest.runTests(repetitions);
+    }
+
+    if (parser.isSet(QStringLiteral("library-sizes"))) {
+        const QStringList sizes = parser.value(QStringLiteral("library-sizes")).split(QLatin1Char(','), QString::SkipEmptyParts);
+        foreach (const QString &size, sizes) {
+            const int messages = size.toInt();
+            if (messages <= 0) {
+                continue;
+            }
+            MailDirGenerator generator;
+            generator.setMessagesPerFolder(messages);
+            generator.setBodySize(parser.value(QStringLiteral("message-size")).toInt());
+            generator.setDuplicatePercentage(5);
+            const QString dir = generatedDir.path() + QStringLiteral("/library-%1").arg(messages);
+            if (!generatedDir.isValid() || !generator.generate(dir)) {
+                qCritical() << "Unable to generate maildir";
+                return 1;
+            }
+            TestMime mimeTest(dir, messages);
+            mimeTest.runTests(repetitions);
+        }
+    }
+
+    QFile out;
+    if (parser.isSet(QStringLiteral("json"))) {
+        out.setFileName(parser.value(QStringLiteral("json")));
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical() << "Unable to open" << out.fileName();
+            return 1;
+        }
+    } else {
+        out.open(stdout, QIODevice::WriteOnly);
+    }
+    return results->writeJson(&out) ? 0 : 1;
 }
@@ -19,6 +19,7 @@
 */
 
 #include "test.h"
+#include "benchmarkresults.h"
 
 #include "KDBusConnectionPool"
 
@@ -26,14 +27,20 @@
 #include <collectiondeletejob.h>
 #include <collectionfetchjob.h>
 #include <collectionfetchscope.h>
+#include <itemfetchjob.h>
+#include <itemfetchscope.h>
 
 #include <QDebug>
-#include <QTest>
 #include <QDBusInterface>
+#include <QEventLoop>
+#include <QTimer>
 
 using namespace Akonadi;
 
 MakeTest::MakeTest()
+    : mLoop(Q_NULLPTR)
+    , mWaitCondition(Finished)
+    , mDone(false)
 {
     connect(AgentManager::self(), SIGNAL(instanceRemoved(Akonadi::AgentInstance)),
             this, SLOT(instanceRemoved(Akonadi::AgentInstance)));
@@ -55,17 +62,15 @@ void MakeTest::createAgent(const QString &name)
     } else {
         qDebug() << "  Created resource instance" << currentInstance.identifier();
     }
-
-    QTest::qWait(100); //fix this hack
 }
 
-void MakeTest::configureDBusIface(const QString &name, const QString &dir)
+void MakeTest::configureDBusIface(const QString &name, const QString &dir, bool readOnly)
 {
     QDBusInterface *configIface = new QDBusInterface(QLatin1String("org.freedesktop.Akonadi.Resource.") + currentInstance.identifier(),
             QStringLiteral("/Settings"), QLatin1String("org.kde.Akonadi.") + name + QLatin1String(".Settings"), KDBusConnectionPool::threadConnection(), this);
 
     configIface->call(QStringLiteral("setPath"), dir);
-    configIface->call(QStringLiteral("setReadOnly"), true);
+    configIface->call(QStringLiteral("setReadOnly"), readOnly);
 
     if (!configIface->isValid()) {
         qFatal("Could not configure instance %s.", qPrintable(currentInstance.identifier()));
@@ -74,9 +79,11 @@ void MakeTest::configureDBusIface(const QString &name, const QString &dir)
 
 void MakeTest::instanceRemoved(const AgentInstance &instance)
 {
-    Q_UNUSED(instance);
-    done = true;
     // qDebug() << "agent removed:" << instance;
+    if (mWaitCondition == ResourceRemoved && instance == currentInstance) {
+        mDone = true;
+        quitLoop();
+    }
 }
 
 void MakeTest::instanceStatusChanged(const AgentInstance &instance)
@@ -86,15 +93,18 @@ void MakeTest::instanceStatusChanged(const AgentInstance &instance)
         if (instance.status() == AgentInstance::Running) {
             //qDebug() << "    " << message;
         }
-        if (instance.status() == AgentInstance::Idle) {
-            done = true;
+        if (instance.status() == AgentInstance::Idle && mWaitCondition == ResourceIdle) {
+            mDone = true;
+            quitLoop();
         }
     }
 }
 
-void MakeTest::outputStats(const QString &description)
+void MakeTest::outputStats(const QString &description, qint64 items, qint64 nsecs)
 {
-    output(description + QLatin1String("\t\t") + currentAccount + QLatin1String("\t\t") + QString::number(timer.elapsed()) + QLatin1Char('\n'));
+    const double msecs = (nsecs < 0 ? timer.nsecsElapsed() : nsecs) / 1000000.0;
+    BenchmarkResults::self()->addSample(currentAccount, description, msecs, items);
+    qDebug() << "   " << description << msecs << "ms," << items << "items";
 }
 
 void MakeTest::output(const QString &message)
@@ -121,7 +131,88 @@ void MakeTest::removeCollections()
 void MakeTest::removeResource()
 {
     qDebug() << "  Removing resource.";
+    prepareWait(ResourceRemoved);
     AgentManager::self()->removeInstance(currentInstance);
+    waitForDone();
+    currentInstance = AgentInstance();
+}
+
+void MakeTest::cleanup()
+{
+    if (currentInstance.isValid()) {
+        removeResource();
+    }
+}
+
+void MakeTest::prepareWait(WaitCondition condition)
+{
+    mWaitCondition = condition;
+    mDone = false;
+}
+
+bool MakeTest::waitForDone(int timeout)
+{
+    if (!mDone) {
+        QEventLoop loop;
+        QTimer::singleShot(timeout, &loop, SLOT(quit()));
+        mLoop = &loop;
+        loop.exec();
+        mLoop = Q_NULLPTR;
+    }
+    const bool done = mDone;
+    if (!done) {
+        qWarning() << "  Timeout while waiting for" << currentInstance.identifier();
+    }
+
+    // nothing arrives for this wait anymore
+    mWaitCondition = Finished;
+    mDone = false;
+    return done;
+}
+
+void MakeTest::finish()
+{
+    if (mWaitCondition == Finished) {
+        mDone = true;
+        quitLoop();
+    }
+}
+
+void MakeTest::quitLoop()
+{
+    if (mLoop) {
+        mLoop->quit();
+    }
+}
+
+qint64 MakeTest::countItems()
+{
+    qint64 count = 0;
+    CollectionFetchJob *clj = new CollectionFetchJob(Collection::root(), CollectionFetchJob::Recursive);
+    clj->fetchScope().setResource(currentInstance.identifier());
+    clj->exec();
+    foreach (const Collection &collection, clj->collections()) {
+        ItemFetchJob *ifj = new ItemFetchJob(collection, this);
+        ifj->fetchScope().setFetchModificationTime(false);
+        ifj->exec();
+        count += ifj->items().count();
+    }
+    return count;
+}
+
+void MakeTest::setInstance(const AgentInstance &instance)
+{
+    currentInstance = instance;
+}
+
+AgentInstance MakeTest::instance() const
+{
+    return currentInstance;
+}
+
+void MakeTest::setAccount(const QString &account)
+{
+    currentAccount = account;
 }
 
 void MakeTest::start()
@@ -24,7 +24,9 @@
 #include <agentmanager.h>
 #include <job.h>
 
-#include <QTime>
+#include <QElapsedTimer>
+
+class QEventLoop;
 
 class MakeTest : public QObject
 {
@@ -32,23 +34,61 @@ class MakeTest : public QObject
     Q_OBJECT
 protected Q_SLOTS:
     void createAgent(const QString &name);
-    void configureDBusIface(const QString &name, const QString &dir);
+    void configureDBusIface(const QString &name, const QString &dir, bool readOnly = true);
     void instanceRemoved(const Akonadi::AgentInstance &instance);
     void instanceStatusChanged(const Akonadi::AgentInstance &instance);
-    void outputStats(const QString &description);
+    void outputStats(const QString &description, qint64 items = 0, qint64 nsecs = -1);
     void output(const QString &message);
+    void finish();
 
 protected:
     Akonadi::AgentInstance currentInstance;
     QString currentAccount;
-    QTime timer;
-    bool done;
+    QElapsedTimer timer;
+
+    /**
+      What waitForDone() waits for.
+    */
+    enum WaitCondition {
+        ResourceIdle,       ///< the current resource reports that it is idle
+        ResourceRemoved,    ///< the current resource has been removed
+        Finished            ///< finish() is called by the awaited job or command
+    };
+
     void removeCollections();
     void removeResource();
+
+    /**
+      Arms the next waitForDone() for @p condition. Must be called before
+      the awaited operation is started, events not matching the condition
+      are ignored.
+    */
+    void prepareWait(WaitCondition condition);
+    bool waitForDone(int timeout = 600000);
+    void quitLoop();
+    qint64 countItems();
     virtual void runTest() = 0;
 public:
     MakeTest();
     void start();
+
+    /** Removes the resource the test operated on, if any. */
+    void cleanup();
+
+    /**
+      Sets the resource the test operates on, for tests which do not
+      create one themselves.
+    */
+    void setInstance(const Akonadi::AgentInstance &instance);
+    Akonadi::AgentInstance instance() const;
+
+    /** Sets the name of the test suite the results are reported for. */
+    void setAccount(const QString &account);
+
+private:
+    QEventLoop *mLoop;
+    WaitCondition mWaitCondition;
+    bool mDone;
 };
 
 #endif
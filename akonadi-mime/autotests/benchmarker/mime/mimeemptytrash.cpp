@@ -0,0 +1,48 @@
+/*
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "mimeemptytrash.h"
+
+#include <QDebug>
+
+#include <emptytrashcommand.h>
+#include <specialmailcollections.h>
+
+using namespace Akonadi;
+
+MimeEmptyTrash::MimeEmptyTrash()
+    : MimeTest()
+{
+}
+
+void MimeEmptyTrash::runTest()
+{
+    const Collection trash = SpecialMailCollections::self()->defaultCollection(SpecialMailCollections::Trash);
+    if (!trash.isValid()) {
+        qWarning() << "  No trash folder to empty.";
+        return;
+    }
+    const qint64 items = this->items(trash).count();
+
+    qDebug() << "  Emptying the trash.";
+    timer.start();
+    execCommand(new EmptyTrashCommand(trash, this));
+    outputStats(QStringLiteral("emptytrashcommand"), items);
+
+    // the messages are not part of the resource which is removed after the run
+    clearTrash();
+}
@@ -0,0 +1,46 @@
+/*
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "mimemarkas.h"
+
+#include <QDebug>
+
+#include <markascommand.h>
+#include <messagestatus.h>
+
+using namespace Akonadi;
+
+MimeMarkAs::MimeMarkAs()
+    : MimeTest()
+{
+}
+
+void MimeMarkAs::runTest()
+{
+    const Collection::List collections = folders();
+    const qint64 items = countItems();
+
+    qDebug() << "  Marking all messages as read.";
+    timer.start();
+    execCommand(new MarkAsCommand(MessageStatus::statusRead(), collections, false, false, this));
+    outputStats(QStringLiteral("markascommand-read"), items);
+
+    qDebug() << "  Marking all messages as unread.";
+    timer.start();
+    execCommand(new MarkAsCommand(MessageStatus::statusRead(), collections, true, false, this));
+    outputStats(QStringLiteral("markascommand-unread"), items);
+}
@@ -0,0 +1,72 @@
+/*
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "mimemessagemodel.h"
+
+#include <QDebug>
+#include <QSortFilterProxyModel>
+
+#include <messagemodel.h>
+
+using namespace Akonadi;
+
+MimeMessageModel::MimeMessageModel()
+    : MimeTest()
+    , mModel(Q_NULLPTR)
+    , mExpectedRows(0)
+{
+}
+
+void MimeMessageModel::runTest()
+{
+    const Collection folder = largestFolder();
+    mExpectedRows = items(folder).count();
+
+    MessageModel model;
+    mModel = &model;
+    connect(&model, &QAbstractItemModel::rowsInserted, this, &MimeMessageModel::rowsInserted);
+
+    qDebug() << "  Populating MessageModel.";
+    prepareWait(Finished);
+    timer.start();
+    model.setCollection(folder);
+    if (mExpectedRows > 0) {
+        waitForDone();
+    }
+    outputStats(QStringLiteral("messagemodel-populate"), model.rowCount());
+
+    QSortFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+
+    qDebug() << "  Sorting MessageModel.";
+    timer.start();
+    proxy.sort(MessageModel::Date);
+    outputStats(QStringLiteral("messagemodel-sort-date"), model.rowCount());
+
+    timer.start();
+    proxy.sort(MessageModel::Subject);
+    outputStats(QStringLiteral("messagemodel-sort-subject"), model.rowCount());
+
+    mModel = Q_NULLPTR;
+}
+
+void MimeMessageModel::rowsInserted()
+{
+    if (mModel && mModel->rowCount() >= mExpectedRows) {
+        finish();
+    }
+}
@@ -0,0 +1,66 @@
+/*
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "mimemovetotrash.h"
+
+#include <QDebug>
+
+#include <changerecorder.h>
+#include <entitytreemodel.h>
+#include <kmime/kmime_message.h>
+
+#include <movetotrashcommand.h>
+#include <specialmailcollections.h>
+#include <specialmailcollectionsrequestjob.h>
+
+using namespace Akonadi;
+
+MimeMoveToTrash::MimeMoveToTrash()
+    : MimeTest()
+{
+}
+
+void MimeMoveToTrash::runTest()
+{
+    SpecialMailCollectionsRequestJob *requestJob = new SpecialMailCollectionsRequestJob(this);
+    requestJob->requestDefaultCollection(SpecialMailCollections::Trash);
+    if (!requestJob->exec()) {
+        qWarning() << "  Unable to get a trash folder:" << requestJob->errorString();
+        return;
+    }
+
+    // MoveToTrashCommand looks the trash folder up in a model
+    ChangeRecorder recorder;
+    recorder.setCollectionMonitored(Collection::root());
+    recorder.setMimeTypeMonitored(KMime::Message::mimeType());
+    EntityTreeModel model(&recorder);
+    model.setItemPopulationStrategy(EntityTreeModel::NoItemPopulation);
+    prepareWait(Finished);
+    connect(&model, &EntityTreeModel::collectionTreeFetched, this, &MimeMoveToTrash::finish);
+    waitForDone(60000);
+
+    // leftovers of an earlier run which did not empty the trash
+    clearTrash();
+
+    const Collection::List collections = folders();
+    const qint64 items = countItems();
+
+    qDebug() << "  Moving all messages to the trash.";
+    timer.start();
+    execCommand(new MoveToTrashCommand(&model, collections, this));
+    outputStats(QStringLiteral("movetotrashcommand"), items);
+}
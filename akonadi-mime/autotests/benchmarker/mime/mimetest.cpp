@@ -0,0 +1,110 @@
+/*
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "mimetest.h"
+
+#include <QDebug>
+
+#include <collectionfetchjob.h>
+#include <collectionfetchscope.h>
+#include <itemfetchjob.h>
+#include <itemdeletejob.h>
+#include <itemfetchscope.h>
+#include <specialmailcollections.h>
+
+using namespace Akonadi;
+
+MimeTest::MimeTest()
+    : MailDir()
+    , mCommand(Q_NULLPTR)
+    , mCommandResult(CommandBase::Undefined)
+{
+}
+
+Collection::List MimeTest::folders()
+{
+    CollectionFetchJob *job = new CollectionFetchJob(Collection::root(), CollectionFetchJob::Recursive, this);
+    job->fetchScope().setResource(currentInstance.identifier());
+    job->exec();
+    return job->collections();
+}
+
+Item::List MimeTest::items(const Collection &collection)
+{
+    ItemFetchJob *job = new ItemFetchJob(collection, this);
+    job->fetchScope().setAncestorRetrieval(ItemFetchScope::Parent);
+    job->exec();
+    return job->items();
+}
+
+Collection MimeTest::largestFolder()
+{
+    Collection largest;
+    int count = -1;
+    foreach (const Collection &collection, folders()) {
+        const int itemCount = items(collection).count();
+        if (itemCount > count) {
+            largest = collection;
+            count = itemCount;
+        }
+    }
+    return largest;
+}
+
+bool MimeTest::execCommand(CommandBase *command)
+{
+    prepareWait(Finished);
+    mCommand = command;
+    mCommandResult = CommandBase::Undefined;
+    connect(command, &CommandBase::result, this, &MimeTest::commandResult);
+    // the command deletes itself once it is done
+    const char *className = command->metaObject()->className();
+    command->execute();
+    waitForDone();
+    mCommand = Q_NULLPTR;
+    if (mCommandResult != CommandBase::OK) {
+        qWarning() << "  Command failed:" << className << mCommandResult;
+    }
+    return mCommandResult == CommandBase::OK;
+}
+
+void MimeTest::commandResult(CommandBase::Result result)
+{
+    // a command of an earlier wait which timed out
+    if (sender() != mCommand) {
+        return;
+    }
+
+    // Commands may report a failure before they are done, keep the first one.
+    if (mCommandResult == CommandBase::Undefined || result == CommandBase::Failed) {
+        mCommandResult = result;
+    }
+    finish();
+}
+
+void MimeTest::clearTrash()
+{
+    const Collection trash = SpecialMailCollections::self()->defaultCollection(SpecialMailCollections::Trash);
+    if (!trash.isValid() || items(trash).isEmpty()) {
+        return;
+    }
+
+    ItemDeleteJob *job = new ItemDeleteJob(trash, this);
+    if (!job->exec()) {
+        qWarning() << "  Unable to clear the trash:" << job->errorString();
+    }
+}
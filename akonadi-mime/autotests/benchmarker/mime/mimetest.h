@@ -0,0 +1,68 @@
+/*
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef MIMETEST_H
+#define MIMETEST_H
+
+#include "../maildir/maildir.h"
+
+#include <commandbase.h>
+#include <collection.h>
+#include <item.h>
+
+/**
+  Base class of the benchmarks for the akonadi-mime library code, operating
+  on the maildir resource imported by the first test of the suite.
+*/
+class MimeTest : public MailDir
+{
+    Q_OBJECT
+
+public:
+    MimeTest();
+
+protected:
+    /** Returns all folders of the current resource. */
+    Akonadi::Collection::List folders();
+
+    /** Returns the items of @p collection, without payload. */
+    Akonadi::Item::List items(const Akonadi::Collection &collection);
+
+    /** Returns the folder of the current resource with the most items. */
+    Akonadi::Collection largestFolder();
+
+    /**
+      Executes @p command and waits for its result. Returns whether the
+      command succeeded.
+    */
+    bool execCommand(Akonadi::CommandBase *command);
+
+    /**
+      Deletes all messages from the trash folder of the default resource,
+      where MoveToTrashCommand moves the messages of the library to.
+    */
+    void clearTrash();
+
+private Q_SLOTS:
+    void commandResult(Akonadi::CommandBase::Result result);
+
+private:
+    Akonadi::CommandBase *mCommand;
+    Akonadi::CommandBase::Result mCommandResult;
+};
+
+#endif
@@ -20,14 +20,38 @@
 
 #include "test.h"
 
+Test::Test(const QString &name)
+    : mName(name)
+{
+}
+
+Test::~Test()
+{
+    qDeleteAll(mListTest);
+}
+
 void Test::addTest(MakeTest *test)
 {
+    test->setAccount(mName);
     mListTest.append(test);
 }
 
-void Test::runTests()
+void Test::runTests(int repetitions)
 {
-    for (int i = 0; i < mListTest.size(); ++i) {
-        mListTest.at(i)->start();
+    for (int run = 0; run < repetitions; ++run) {
+        Akonadi::AgentInstance instance;
+        MakeTest *last = Q_NULLPTR;
+        for (int i = 0; i < mListTest.size(); ++i) {
+            MakeTest *test = mListTest.at(i);
+            if (instance.isValid()) {
+                test->setInstance(instance);
+            }
+            test->start();
+            instance = test->instance();
+            last = test;
+        }
+        if (last) {
+            last->cleanup();
+        }
     }
 }
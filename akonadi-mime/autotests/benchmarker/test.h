@@ -28,10 +28,21 @@ class Test
 
 protected:
     QList<MakeTest *> mListTest;
+    QString mName;
 
 public:
+    explicit Test(const QString &name);
+    ~Test();
     void addTest(MakeTest *test);
-    void runTests();
+
+    /**
+      Runs all tests @p repetitions times. The first test of the suite is
+      expected to create and import the resource, the following tests then
+      operate on it. The resource is removed after every repetition, and
+      MailDirImport imports a fresh copy of a modifiable maildir, so each
+      repetition starts from the same data.
+    */
+    void runTests(int repetitions = 1);
 };
 
 #endif
@@ -22,11 +22,25 @@
 #include "maildir/maildirfetchallheaders.h"
 #include "maildir/maildir20percentread.h"
 #include "maildir/maildirfetchunreadheaders.h"
+#include "maildir/maildirremovereadmessages.h"
 
-TestMailDir::TestMailDir(const QString &dir)
+TestMailDir::TestMailDir(const QString &dir, bool readOnly)
+    : Test(QStringLiteral("maildir"))
 {
-    addTest(new MailDirImport(dir));
+    MailDirImport *import = new MailDirImport(dir);
+    import->setReadOnly(readOnly);
+    addTest(import);
     addTest(new MailDirFetchAllHeaders());
     addTest(new MailDir20PercentAsRead());
+    if (!readOnly) {
+        addTest(new MailDir20PercentAsRead(MailDir::Batch, 100));
+        addTest(new MailDir20PercentAsRead(MailDir::InFlight, 8));
+    }
     addTest(new MailDirFetchUnreadHeaders());
+    if (!readOnly) {
+        // every variant removes a third of the read messages
+        addTest(new MailDirRemoveReadMessages(MailDir::PerItem, 1, 0, 3));
+        addTest(new MailDirRemoveReadMessages(MailDir::Batch, 100, 1, 3));
+        addTest(new MailDirRemoveReadMessages(MailDir::InFlight, 8, 2, 3));
+    }
 }
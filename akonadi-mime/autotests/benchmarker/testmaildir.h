@@ -25,6 +25,11 @@
 class TestMailDir : public Test
 {
 public:
-    TestMailDir(const QString &dir);
+    /**
+      Creates the maildir benchmark suite for @p dir. Unless @p readOnly is
+      false, the benchmarks comparing strategies for modifying and removing
+      many messages are left out, as they change the maildir.
+    */
+    explicit TestMailDir(const QString &dir, bool readOnly = true);
 };
 #endif
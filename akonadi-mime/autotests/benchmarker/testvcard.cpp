@@ -21,6 +21,7 @@
 #include "vcard/vcardimport.h"
 
 TestVCard::TestVCard(const QString &dir)
+    : Test(QStringLiteral("vcard"))
 {
     addTest(new VCardImport(dir));
 }
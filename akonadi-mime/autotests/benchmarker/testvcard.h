@@ -25,6 +25,6 @@
 class TestVCard : public Test
 {
 public:
-    TestVCard(const QString &dir);
+    explicit TestVCard(const QString &dir);
 };
 #endif
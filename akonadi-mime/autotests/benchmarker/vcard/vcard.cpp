@@ -21,12 +21,20 @@
 
 VCard::VCard(const QString &dir)
     : MakeTest()
+    , mDir(dir)
 {
-    createAgent(QStringLiteral("akonadi_vcarddir_resource"));
-    configureDBusIface(QStringLiteral("VCard"), dir);
 }
 
 VCard::VCard()
     : MakeTest()
 {
 }
+
+void VCard::createResource()
+{
+    prepareWait(ResourceIdle);
+    createAgent(QStringLiteral("akonadi_vcarddir_resource"));
+    configureDBusIface(QStringLiteral("VCard"), mDir);
+    // wait for the resource to come up before measuring anything
+    waitForDone();
+}
@@ -28,6 +28,11 @@ class VCard : public MakeTest
 public:
     VCard(const QString &dir);
     VCard();
+
+protected:
+    void createResource();
+
+    QString mDir;
 };
 
 #endif
@@ -19,11 +19,8 @@
 
 #include "vcardimport.h"
 #include "vcard.h"
-#include <QTest>
 #include <QDebug>
 
-#define WAIT_TIME 50
-
 VCardImport::VCardImport(const QString &dir)
     : VCard(dir)
 {
@@ -31,12 +28,14 @@ VCardImport::VCardImport(const QString &dir)
 
 void VCardImport::runTest()
 {
-    done = false;
+    createResource();
+
+    prepareWait(ResourceIdle);
     timer.start();
     qDebug() << "Synchronising resource";
     currentInstance.synchronize();
-    while (!done) {
-        QTest::qWait(WAIT_TIME);
-    }
-    outputStats(QStringLiteral("import"));
+    waitForDone();
+    const qint64 elapsed = timer.nsecsElapsed();
+    const qint64 items = countItems();
+    outputStats(QStringLiteral("import"), items, elapsed);
 }
@@ -196,4 +196,31 @@ void LocalFoldersRequestJobTest::testMixedRequest()
     QCOMPARE(smc->collection(SpecialMailCollections::Outbox, AgentManager::self()->instance(res1.resource())), knutOutbox);
 }
 
+void LocalFoldersRequestJobTest::testRequestAllDefaultCollections()
+{
+    SpecialMailCollections *smc = SpecialMailCollections::self();
+    Q_ASSERT(smc);
+    QSignalSpy defSpy(smc, SIGNAL(defaultCollectionsChanged()));
+    QVERIFY(defSpy.isValid());
+
+    // Outbox and SentMail exist already (from the above functions).
+    QVERIFY(smc->hasDefaultCollection(SpecialMailCollections::Outbox));
+    QVERIFY(smc->hasDefaultCollection(SpecialMailCollections::SentMail));
+    const Collection oldOutbox = smc->defaultCollection(SpecialMailCollections::Outbox);
+
+    // Request all default folders with a single job.
+    {
+        SpecialMailCollectionsRequestJob *rjob = new SpecialMailCollectionsRequestJob(this);
+        rjob->requestAllDefaultCollections();
+        AKVERIFYEXEC(rjob);
+        QVERIFY(defSpy.count() <= 1);
+        for (int type = SpecialMailCollections::Root; type < SpecialMailCollections::LastType; ++type) {
+            QVERIFY(smc->hasDefaultCollection(static_cast<SpecialMailCollections::Type>(type)));
+        }
+    }
+
+    // This should be untouched.
+    QCOMPARE(smc->defaultCollection(SpecialMailCollections::Outbox), oldOutbox);
+}
+
 QTEST_AKONADIMAIN(LocalFoldersRequestJobTest, NoGUI)
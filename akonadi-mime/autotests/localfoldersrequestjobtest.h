@@ -33,6 +33,7 @@ private Q_SLOTS:
     void testRequestWithNoDefaultResourceExisting();
     void testRequestWithDefaultResourceAlreadyExisting();
     void testMixedRequest();
+    void testRequestAllDefaultCollections();
 };
 
 #endif
@@ -0,0 +1,188 @@
+/*
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "addressattributetest.h"
+
+#include <addressattribute.h>
+
+#include <QDataStream>
+#include <qtest.h>
+
+using namespace Akonadi;
+
+QTEST_MAIN(AddressAttributeTest)
+
+static QStringList makeRecipients(int count, const QString &prefix)
+{
+    QStringList list;
+    for (int i = 0; i < count; ++i) {
+        list << QStringLiteral("%1%2@%3.example.org").arg(prefix).arg(i).arg(i % 3);
+    }
+    return list;
+}
+
+void AddressAttributeTest::testRoundTrip()
+{
+    const QString from = QStringLiteral("Sender <sender@example.org>");
+    const QStringList to = QStringList() << QStringLiteral("Jörg <joerg@example.org>")
+                           << QStringLiteral("no-domain") << QString();
+    const QStringList cc = makeRecipients(5, QStringLiteral("cc"));
+    const QStringList bcc = QStringList() << QStringLiteral("a@b@c.example.org");
+
+    AddressAttribute attr(from, to, cc, bcc);
+    AddressAttribute copy;
+    copy.deserialize(attr.serialized());
+
+    QCOMPARE(copy.from(), from);
+    QCOMPARE(copy.to(), to);
+    QCOMPARE(copy.cc(), cc);
+    QCOMPARE(copy.bcc(), bcc);
+
+    QScopedPointer<AddressAttribute> clone(copy.clone());
+    QCOMPARE(clone->to(), to);
+    QCOMPARE(clone->serialized(), attr.serialized());
+}
+
+void AddressAttributeTest::testReadOldFormat()
+{
+    const QString from = QStringLiteral("sender@example.org");
+    const QStringList to = makeRecipients(3, QStringLiteral("to"));
+    const QStringList cc = makeRecipients(2, QStringLiteral("cc"));
+    const QStringList bcc;
+
+    QByteArray data;
+    QDataStream serializer(&data, QIODevice::WriteOnly);
+    serializer.setVersion(QDataStream::Qt_4_5);
+    serializer << from << to << cc << bcc;
+
+    AddressAttribute attr;
+    attr.deserialize(data);
+    QCOMPARE(attr.from(), from);
+    QCOMPARE(attr.to(), to);
+    QCOMPARE(attr.cc(), cc);
+    QCOMPARE(attr.bcc(), bcc);
+
+    // an empty sender must not be mistaken for the compact format either
+    data.clear();
+    QDataStream emptySender(&data, QIODevice::WriteOnly);
+    emptySender.setVersion(QDataStream::Qt_4_5);
+    emptySender << QString() << to << cc << bcc;
+    attr.deserialize(data);
+    QVERIFY(attr.from().isEmpty());
+    QCOMPARE(attr.to(), to);
+}
+
+void AddressAttributeTest::testCompactSize()
+{
+    const QStringList to = makeRecipients(1000, QStringLiteral("recipient"));
+
+    QByteArray oldData;
+    QDataStream serializer(&oldData, QIODevice::WriteOnly);
+    serializer.setVersion(QDataStream::Qt_4_5);
+    serializer << QString() << to << QStringList() << QStringList();
+
+    AddressAttribute attr(QString(), to);
+    QVERIFY(attr.serialized().size() * 3 < oldData.size());
+}
+
+void AddressAttributeTest::testForEachRecipient()
+{
+    const QStringList to = makeRecipients(3, QStringLiteral("to"));
+    const QStringList cc = makeRecipients(2, QStringLiteral("cc"));
+    const QStringList bcc = makeRecipients(1, QStringLiteral("bcc"));
+    const AddressAttribute source(QString(), to, cc, bcc);
+
+    AddressAttribute decoded(QString(), to, cc, bcc);
+    AddressAttribute lazy;
+    lazy.deserialize(source.serialized());
+
+    const AddressAttribute *attributes[] = { &decoded, &lazy };
+    for (const AddressAttribute *attr : attributes) {
+        QStringList all;
+        QList<AddressAttribute::RecipientType> types;
+        QVERIFY(attr->forEachRecipient([&](AddressAttribute::RecipientType type, const QString & address) {
+            types << type;
+            all << address;
+            return true;
+        }));
+        QCOMPARE(all, to + cc + bcc);
+        QCOMPARE(types.count(AddressAttribute::To), to.count());
+        QCOMPARE(types.count(AddressAttribute::Cc), cc.count());
+        QCOMPARE(types.count(AddressAttribute::Bcc), bcc.count());
+
+        int visited = 0;
+        QVERIFY(!attr->forEachRecipient([&](AddressAttribute::RecipientType, const QString &) {
+            return ++visited < 2;
+        }));
+        QCOMPARE(visited, 2);
+    }
+}
+
+void AddressAttributeTest::testModifyAfterDeserialize()
+{
+    const AddressAttribute source(QStringLiteral("sender@example.org"),
+                                  makeRecipients(3, QStringLiteral("to")));
+    AddressAttribute attr;
+    attr.deserialize(source.serialized());
+
+    const QStringList cc = makeRecipients(2, QStringLiteral("cc"));
+    attr.setCc(cc);
+
+    AddressAttribute copy;
+    copy.deserialize(attr.serialized());
+    QCOMPARE(copy.from(), source.from());
+    QCOMPARE(copy.to(), source.to());
+    QCOMPARE(copy.cc(), cc);
+}
+
+void AddressAttributeTest::testTruncatedData()
+{
+    const AddressAttribute source(QStringLiteral("sender@example.org"),
+                                  makeRecipients(10, QStringLiteral("to")));
+    const QByteArray data = source.serialized();
+
+    for (int size = 0; size < data.size(); ++size) {
+        AddressAttribute attr;
+        attr.deserialize(data.left(size));
+        QVERIFY(attr.to().size() <= 10);
+    }
+
+    // Sizes from the 4 byte header on are read as compact data
+    for (int size = 4; size < data.size(); ++size) {
+        AddressAttribute attr;
+        attr.deserialize(data.left(size));
+        QVERIFY(!attr.forEachRecipient([](AddressAttribute::RecipientType, const QString &) {
+            return true;
+        }));
+    }
+}
+
+void AddressAttributeTest::testUnknownVersion()
+{
+    const AddressAttribute source(QStringLiteral("sender@example.org"),
+                                  makeRecipients(3, QStringLiteral("to")));
+    QByteArray data = source.serialized();
+    data[3] = 0x02;
+
+    // Rejected instead of being read as the old QDataStream format
+    AddressAttribute attr(QStringLiteral("previous@example.org"));
+    attr.deserialize(data);
+    QVERIFY(attr.from().isEmpty());
+    QVERIFY(attr.to().isEmpty());
+    QVERIFY(attr.cc().isEmpty());
+    QVERIFY(attr.bcc().isEmpty());
+}
@@ -0,0 +1,197 @@
+/*
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "messagestatusbenchmark.h"
+
+#include <messageflags.h>
+
+#include <qtest.h>
+
+using namespace Akonadi;
+
+QTEST_MAIN(MessageStatusBenchmark)
+
+Q_DECLARE_METATYPE(QVector<QSet<QByteArray> >)
+
+static const int s_messageCount = 10000;
+
+// Builds flag sets as delivered for a typical IMAP inbox: most messages
+// are seen, some answered, flagged or with attachments, plus the odd
+// server specific keyword. IMAP flags are case-insensitive and servers
+// send them in mixed case, unlike the upper-case Akonadi::MessageFlags.
+static QVector<QSet<QByteArray> > createFlags(bool imapCase)
+{
+    QVector<QSet<QByteArray> > result;
+    result.reserve(s_messageCount);
+    for (int i = 0; i < s_messageCount; ++i) {
+        QSet<QByteArray> flags;
+        if (i % 10 < 7) {
+            flags << (imapCase ? QByteArray("\\Seen") : QByteArray(MessageFlags::Seen));
+        }
+        if (i % 10 == 3) {
+            flags << (imapCase ? QByteArray("\\Answered") : QByteArray(MessageFlags::Answered));
+        }
+        if (i % 20 == 5) {
+            flags << (imapCase ? QByteArray("\\Flagged") : QByteArray(MessageFlags::Flagged));
+        }
+        if (i % 33 == 7) {
+            flags << (imapCase ? QByteArray("$Forwarded") : QByteArray(MessageFlags::Forwarded));
+        }
+        if (i % 5 == 1) {
+            flags << (imapCase ? QByteArray("$Attachment") : QByteArray(MessageFlags::HasAttachment));
+        }
+        if (i % 50 == 9) {
+            flags << (imapCase ? QByteArray("$Junk") : QByteArray(MessageFlags::Spam));
+        } else if (i % 50 == 19) {
+            flags << (imapCase ? QByteArray("$NotJunk") : QByteArray(MessageFlags::Ham));
+        }
+        if (i % 100 == 42) {
+            flags << (imapCase ? QByteArray("\\Deleted") : QByteArray(MessageFlags::Deleted));
+        }
+        if (imapCase && i % 7 == 0) {
+            flags << QByteArray("$label1") << QByteArray("NonJunk");
+        }
+        result.append(flags);
+    }
+    return result;
+}
+
+void MessageStatusBenchmark::initTestCase()
+{
+    mAkonadiFlags = createFlags(false);
+
+    mStatus.reserve(mAkonadiFlags.size());
+    mStatusStr.reserve(mAkonadiFlags.size());
+    foreach (const QSet<QByteArray> &flags, mAkonadiFlags) {
+        MessageStatus status;
+        status.setStatusFromFlags(flags);
+        mStatus.append(status);
+        mStatusStr.append(status.statusStr());
+    }
+}
+
+void MessageStatusBenchmark::benchmarkSetStatusFromFlags_data()
+{
+    QTest::addColumn<QVector<QSet<QByteArray> > >("flags");
+
+    QTest::newRow("akonadi") << createFlags(false);
+    QTest::newRow("imap") << createFlags(true);
+}
+
+void MessageStatusBenchmark::benchmarkSetStatusFromFlags()
+{
+    QFETCH(QVector<QSet<QByteArray> >, flags);
+
+    int read = 0;
+    QBENCHMARK {
+        read = 0;
+        foreach (const QSet<QByteArray> &itemFlags, flags) {
+            MessageStatus status;
+            status.setStatusFromFlags(itemFlags);
+            read += status.isRead();
+        }
+    }
+    QVERIFY(read > 0);
+}
+
+void MessageStatusBenchmark::benchmarkStatusFlags()
+{
+    int count = 0;
+    QBENCHMARK {
+        count = 0;
+        foreach (const MessageStatus &status, mStatus) {
+            count += status.statusFlags().size();
+        }
+    }
+    QVERIFY(count > 0);
+}
+
+void MessageStatusBenchmark::benchmarkOperatorAnd()
+{
+    const MessageStatus read = MessageStatus::statusRead();
+    const MessageStatus unread = MessageStatus::statusUnread();
+    const MessageStatus important = MessageStatus::statusImportant();
+
+    int matches = 0;
+    QBENCHMARK {
+        matches = 0;
+        foreach (const MessageStatus &status, mStatus) {
+            matches += (status & read);
+            matches += (status & unread);
+            matches += (status & important);
+        }
+    }
+    QVERIFY(matches > 0);
+}
+
+void MessageStatusBenchmark::benchmarkSet()
+{
+    const MessageStatus important = MessageStatus::statusImportant();
+
+    // detach once outside the measurement, repeating set() is idempotent
+    QVector<MessageStatus> stati = mStatus;
+    stati.detach();
+
+    QBENCHMARK {
+        for (int i = 0; i < stati.size(); ++i) {
+            stati[i].set(important);
+        }
+    }
+    QVERIFY(stati.first().isImportant());
+}
+
+void MessageStatusBenchmark::benchmarkToggle()
+{
+    const MessageStatus read = MessageStatus::statusRead();
+
+    // detach once outside the measurement, every iteration toggles back
+    // and forth over the same data
+    QVector<MessageStatus> stati = mStatus;
+    stati.detach();
+
+    QBENCHMARK {
+        for (int i = 0; i < stati.size(); ++i) {
+            stati[i].toggle(read);
+        }
+    }
+}
+
+void MessageStatusBenchmark::benchmarkStatusStr()
+{
+    int length = 0;
+    QBENCHMARK {
+        length = 0;
+        foreach (const MessageStatus &status, mStatus) {
+            length += status.statusStr().length();
+        }
+    }
+    QVERIFY(length > 0);
+}
+
+void MessageStatusBenchmark::benchmarkSetStatusFromStr()
+{
+    int read = 0;
+    QBENCHMARK {
+        read = 0;
+        foreach (const QString &str, mStatusStr) {
+            MessageStatus status;
+            status.setStatusFromStr(str);
+            read += status.isRead();
+        }
+    }
+    QVERIFY(read > 0);
+}
@@ -18,23 +18,255 @@
 */
 
 #include "addressattribute.h"
+#include "akonadi_mime_debug.h"
 
 #include <QDataStream>
+#include <QHash>
+#include <QVector>
 
 #include <attributefactory.h>
 
 using namespace Akonadi;
 
+namespace
+{
+
+// The compact format starts with this tag followed by a format version.
+// Read as a big-endian quint32 the header is odd, so it can never be
+// mistaken for the length of the first QString of the old QDataStream
+// based format, which is always even or 0xffffffff.
+static const char s_compactTag[] = { 'A', 'D', 'R' };
+static const char s_compactVersion = 0x01;
+static const int s_compactHeaderSize = 4;
+
+bool hasCompactTag(const QByteArray &data)
+{
+    return data.size() >= s_compactHeaderSize
+           && data.at(0) == s_compactTag[0]
+           && data.at(1) == s_compactTag[1]
+           && data.at(2) == s_compactTag[2];
+}
+
+bool isCompactFormat(const QByteArray &data)
+{
+    return hasCompactTag(data) && data.at(3) == s_compactVersion;
+}
+
+void writeVarint(QByteArray &out, quint32 value)
+{
+    while (value >= 0x80) {
+        out.append(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+void writeString(QByteArray &out, const QByteArray &utf8)
+{
+    writeVarint(out, utf8.size());
+    out.append(utf8);
+}
+
+/**
+  @internal
+  Bounds-checked reader for the compact format. After a read error all
+  further reads return empty values.
+*/
+class CompactReader
+{
+public:
+    explicit CompactReader(const QByteArray &data)
+        : mPos(data.constData() + qMin(data.size(), s_compactHeaderSize))
+        , mEnd(data.constData() + data.size())
+        , mOk(isCompactFormat(data))
+    {
+    }
+
+    bool isOk() const
+    {
+        return mOk;
+    }
+
+    quint32 readVarint()
+    {
+        quint32 value = 0;
+        for (int shift = 0; mOk && shift < 32; shift += 7) {
+            if (mPos == mEnd) {
+                break;
+            }
+            const uchar byte = uchar(*mPos++);
+            value |= quint32(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        mOk = false;
+        return 0;
+    }
+
+    QString readString()
+    {
+        const quint32 size = readVarint();
+        if (!mOk || size > quint32(mEnd - mPos)) {
+            mOk = false;
+            return QString();
+        }
+        const QString str = QString::fromUtf8(mPos, size);
+        mPos += size;
+        return str;
+    }
+
+private:
+    const char *mPos;
+    const char *const mEnd;
+    bool mOk;
+};
+
+/**
+  @internal
+  Walks the compact data. Addresses are appended to @p lists (indexed by
+  AddressAttribute::RecipientType) if given, and passed to @p visitor if
+  it is set. Returns @c false if the visitor stopped the iteration or the
+  data is truncated or corrupt; whatever was read up to that point is kept.
+*/
+bool readCompact(const QByteArray &data, QString *from, QStringList *lists[3],
+                 const AddressAttribute::RecipientVisitor &visitor)
+{
+    CompactReader reader(data);
+
+    const quint32 domainCount = reader.readVarint();
+    QVector<QString> domains;
+    domains.reserve(qMin<quint32>(domainCount, data.size()));
+    for (quint32 i = 0; i < domainCount && reader.isOk(); ++i) {
+        domains.append(reader.readString());
+    }
+
+    const QString sender = reader.readString();
+    if (!reader.isOk()) {
+        return false;
+    }
+    if (from) {
+        *from = sender;
+    }
+
+    const AddressAttribute::RecipientType types[] = {
+        AddressAttribute::To, AddressAttribute::Cc, AddressAttribute::Bcc
+    };
+    for (AddressAttribute::RecipientType type : types) {
+        const quint32 count = reader.readVarint();
+        if (!reader.isOk()) {
+            return false;
+        }
+        if (lists) {
+            lists[type]->reserve(qMin<quint32>(count, data.size()));
+        }
+        for (quint32 i = 0; i < count; ++i) {
+            const quint32 domain = reader.readVarint();
+            QString address = reader.readString();
+            if (!reader.isOk() || domain > quint32(domains.size())) {
+                return false;
+            }
+            if (domain > 0) {
+                address += QLatin1Char('@') + domains.at(domain - 1);
+            }
+            if (lists) {
+                lists[type]->append(address);
+            }
+            if (visitor && !visitor(type, address)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}
+
 /**
   @internal
 */
 class AddressAttribute::Private
 {
 public:
+    Private()
+        : mDecoded(true)
+    {
+    }
+
+    void ensureDecoded()
+    {
+        if (mDecoded) {
+            return;
+        }
+        mDecoded = true;
+
+        QStringList *lists[] = { &mTo, &mCc, &mBcc };
+        readCompact(mCompact, &mFrom, lists, RecipientVisitor());
+    }
+
+    void detach()
+    {
+        ensureDecoded();
+        mCompact.clear();
+    }
+
+    QByteArray encode() const
+    {
+        // Collect the domain table first, addresses then refer to it by index.
+        QHash<QString, int> domainIndex;
+        QStringList domains;
+        const QStringList *lists[] = { &mTo, &mCc, &mBcc };
+        for (const QStringList *l : lists) {
+            foreach (const QString &address, *l) {
+                const int at = address.lastIndexOf(QLatin1Char('@'));
+                if (at < 0) {
+                    continue;
+                }
+                const QString domain = address.mid(at + 1);
+                if (!domainIndex.contains(domain)) {
+                    domains.append(domain);
+                    domainIndex.insert(domain, domains.size());
+                }
+            }
+        }
+
+        QByteArray data;
+        data.append(s_compactTag, sizeof(s_compactTag));
+        data.append(s_compactVersion);
+
+        writeVarint(data, domains.size());
+        foreach (const QString &domain, domains) {
+            writeString(data, domain.toUtf8());
+        }
+
+        writeString(data, mFrom.toUtf8());
+
+        for (const QStringList *l : lists) {
+            writeVarint(data, l->size());
+            foreach (const QString &address, *l) {
+                const int at = address.lastIndexOf(QLatin1Char('@'));
+                if (at < 0) {
+                    writeVarint(data, 0);
+                    writeString(data, address.toUtf8());
+                } else {
+                    writeVarint(data, domainIndex.value(address.mid(at + 1)));
+                    writeString(data, address.leftRef(at).toUtf8());
+                }
+            }
+        }
+        return data;
+    }
+
     QString mFrom;
     QStringList mTo;
     QStringList mCc;
     QStringList mBcc;
+
+    // Serialized compact data, either received through deserialize() and
+    // not decoded yet, or cached from the last call of serialized().
+    // Cleared whenever the attribute is modified.
+    QByteArray mCompact;
+    bool mDecoded;
 };
 
 AddressAttribute::AddressAttribute(const QString &from, const QStringList &to,
@@ -54,7 +286,9 @@ AddressAttribute::~AddressAttribute()
 
 AddressAttribute *AddressAttribute::clone() const
 {
-    return new AddressAttribute(d->mFrom, d->mTo, d->mCc, d->mBcc);
+    AddressAttribute *attr = new AddressAttribute;
+    *attr->d = *d;
+    return attr;
 }
 
 QByteArray AddressAttribute::type() const
@@ -65,18 +299,35 @@ QByteArray AddressAttribute::type() const
 
 QByteArray AddressAttribute::serialized() const
 {
-    QByteArray serializedData;
-    QDataStream serializer(&serializedData, QIODevice::WriteOnly);
-    serializer.setVersion(QDataStream::Qt_4_5);
-    serializer << d->mFrom;
-    serializer << d->mTo;
-    serializer << d->mCc;
-    serializer << d->mBcc;
-    return serializedData;
+    if (d->mCompact.isEmpty()) {
+        d->mCompact = d->encode();
+    }
+    return d->mCompact;
 }
 
 void AddressAttribute::deserialize(const QByteArray &data)
 {
+    d->mFrom.clear();
+    d->mTo.clear();
+    d->mCc.clear();
+    d->mBcc.clear();
+
+    if (hasCompactTag(data)) {
+        if (!isCompactFormat(data)) {
+            // Written by a newer version, the old format cannot have this tag
+            qCWarning(AKONADIMIME_LOG) << "Unsupported AddressAttribute format version" << int(data.at(3));
+            d->mCompact.clear();
+            d->mDecoded = true;
+            return;
+        }
+        d->mCompact = data;
+        d->mDecoded = false;
+        return;
+    }
+
+    // Format written by versions before 5.3
+    d->mCompact.clear();
+    d->mDecoded = true;
     QDataStream deserializer(data);
     deserializer.setVersion(QDataStream::Qt_4_5);
     deserializer >> d->mFrom;
@@ -85,43 +336,68 @@ void AddressAttribute::deserialize(const QByteArray &data)
     deserializer >> d->mBcc;
 }
 
+bool AddressAttribute::forEachRecipient(const RecipientVisitor &visitor) const
+{
+    if (!d->mDecoded) {
+        return readCompact(d->mCompact, Q_NULLPTR, Q_NULLPTR, visitor);
+    }
+
+    const QStringList *lists[] = { &d->mTo, &d->mCc, &d->mBcc };
+    for (int type = To; type <= Bcc; ++type) {
+        foreach (const QString &address, *lists[type]) {
+            if (!visitor(static_cast<RecipientType>(type), address)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 QString AddressAttribute::from() const
 {
+    d->ensureDecoded();
     return d->mFrom;
 }
 
 void AddressAttribute::setFrom(const QString &from)
 {
+    d->detach();
     d->mFrom = from;
 }
 
 QStringList AddressAttribute::to() const
 {
+    d->ensureDecoded();
     return d->mTo;
 }
 
 void AddressAttribute::setTo(const QStringList &to)
 {
+    d->detach();
     d->mTo = to;
 }
 
 QStringList AddressAttribute::cc() const
 {
+    d->ensureDecoded();
     return d->mCc;
 }
 
 void AddressAttribute::setCc(const QStringList &cc)
 {
+    d->detach();
     d->mCc = cc;
 }
 
 QStringList AddressAttribute::bcc() const
 {
+    d->ensureDecoded();
     return d->mBcc;
 }
 
 void AddressAttribute::setBcc(const QStringList &bcc)
 {
+    d->detach();
     d->mBcc = bcc;
 }
 
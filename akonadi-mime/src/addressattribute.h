@@ -25,6 +25,8 @@
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 
+#include <functional>
+
 #include <attribute.h>
 
 namespace MailTransport
@@ -38,12 +40,39 @@ namespace Akonadi
 /**
   Attribute storing the From, To, Cc, Bcc addresses of a message.
 
+  The attribute is serialized in a compact, versioned binary format
+  (UTF-8 strings, variable-length integers and a table of deduplicated
+  address domains), which keeps items of mass mailings with thousands of
+  recipients small. Data written by older versions in the QDataStream
+  based format is still read transparently.
+
+  Deserialized data is decoded lazily, so that code which only needs to
+  walk the recipients can use forEachRecipient() without building the
+  address lists.
+
   @author Constantin Berzan <exit3219@gmail.com>
   @since 4.4
 */
 class AKONADI_MIME_EXPORT AddressAttribute : public Akonadi::Attribute
 {
 public:
+    /**
+      Describes which header a recipient belongs to.
+      @since 5.3
+    */
+    enum RecipientType {
+        To,     ///< A receiver from the "To:" header
+        Cc,     ///< A receiver from the "Cc:" header
+        Bcc     ///< A receiver from the "Bcc:" header
+    };
+
+    /**
+      Callback type for forEachRecipient(). Returning @c false stops the
+      iteration.
+      @since 5.3
+    */
+    typedef std::function<bool(RecipientType type, const QString &address)> RecipientVisitor;
+
     /**
       Creates a new AddressAttribute.
     */
@@ -105,6 +134,22 @@ public:
     */
     void setBcc(const QStringList &bcc);
 
+    /**
+      Calls @p visitor for every "To:", "Cc:" and "Bcc:" receiver, in this
+      order.
+
+      If the attribute was deserialized and not modified since, the
+      receivers are read directly from the serialized data without
+      building the address lists. Each address is still decoded into a
+      temporary QString before it is passed to @p visitor.
+
+      @param visitor the callback to invoke for every receiver
+      @return @c false if the visitor stopped the iteration or the serialized
+      data is truncated or corrupt, @c true otherwise
+      @since 5.3
+    */
+    bool forEachRecipient(const RecipientVisitor &visitor) const;
+
 private:
     class Private;
     Private *const d;
@@ -23,6 +23,7 @@
 #include "specialmailcollections.h"
 
 #include "akonadi_mime_debug.h"
+#include "trace_p.h"
 #include <KLocalizedString>
 #include <KMessageBox>
 
@@ -105,6 +106,7 @@ void EmptyTrashCommand::expunge(const Akonadi::Collection &col)
 {
     if (col.isValid()) {
         Akonadi::ItemFetchJob *job = new Akonadi::ItemFetchJob(col, this);
+        Trace::traceJob(job, "EmptyTrashCommand::fetch");
         connect(job, &Akonadi::ItemFetchJob::result, this, &EmptyTrashCommand::slotExpungeJob);
     } else {
         qCDebug(AKONADIMIME_LOG) << " Try to expunge an invalid collection :" << col;
@@ -130,6 +132,7 @@ void EmptyTrashCommand::slotExpungeJob(KJob *job)
         return;
     }
     Akonadi::ItemDeleteJob *jobDelete = new Akonadi::ItemDeleteJob(lstItem, this);
+    Trace::traceJob(jobDelete, "EmptyTrashCommand::delete", lstItem.size());
     connect(jobDelete, &Akonadi::ItemDeleteJob::result, this, &EmptyTrashCommand::slotDeleteJob);
 
 }
@@ -173,7 +176,7 @@ Akonadi::Collection EmptyTrashCommand::trashCollectionFolder()
 
 bool EmptyTrashCommand::folderIsTrash(const Akonadi::Collection &col)
 {
-    if (col == Akonadi::SpecialMailCollections::self()->defaultCollection(Akonadi::SpecialMailCollections::Trash)) {
+    if (Akonadi::SpecialMailCollections::self()->defaultCollectionType(col) == Akonadi::SpecialMailCollections::Trash) {
         return true;
     }
     const Akonadi::AgentInstance::List lst = agentInstances();
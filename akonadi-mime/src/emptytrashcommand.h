@@ -21,6 +21,7 @@
 #define EMPTYTRASHCOMMAND_P_H
 
 #include "commandbase.h"
+#include "akonadi-mimeprivate_export.h"
 
 #include <agentinstance.h>
 #include <collection.h>
@@ -29,7 +30,7 @@ class QAbstractItemModel;
 class KJob;
 namespace Akonadi
 {
-class EmptyTrashCommand : public CommandBase
+class AKONADI_KMIME_TEST_EXPORT EmptyTrashCommand : public CommandBase
 {
     Q_OBJECT
 
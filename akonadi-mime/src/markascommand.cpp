@@ -20,6 +20,7 @@
 #include "markascommand.h"
 #include "util_p.h"
 #include "akonadi_mime_debug.h"
+#include "trace_p.h"
 #include <itemfetchjob.h>
 #include <itemfetchscope.h>
 #include <itemmodifyjob.h>
@@ -108,6 +109,8 @@ void MarkAsCommand::slotFetchDone(KJob *job)
     }
 
     Akonadi::ItemFetchJob *fjob = static_cast<Akonadi::ItemFetchJob *>(job);
+    Trace::TraceSpan span("MarkAsCommand::filter");
+    span.setItemCount(fjob->items().size());
     d->mMessages.clear();
     foreach (const Akonadi::Item &item, fjob->items()) {
         Akonadi::MessageStatus status;
@@ -120,6 +123,8 @@ void MarkAsCommand::slotFetchDone(KJob *job)
             d->mMessages.append(item);
         }
     }
+    span.finish();
+
     if (d->mMessages.empty()) {
         if (d->mFolderListJobCount == 0) {
             emitResult(OK);
@@ -131,6 +136,7 @@ void MarkAsCommand::slotFetchDone(KJob *job)
     if (d->mFolderListJobCount > 0) {
         Akonadi::ItemFetchJob *job = new Akonadi::ItemFetchJob(d->mFolders[d->mFolderListJobCount - 1], parent());
         job->fetchScope().setAncestorRetrieval(Akonadi::ItemFetchScope::Parent);
+        Trace::traceJob(job, "MarkAsCommand::fetch");
         connect(job, &Akonadi::ItemFetchJob::result, this, &MarkAsCommand::slotFetchDone);
     }
 }
@@ -142,6 +148,7 @@ void MarkAsCommand::execute()
                                        i18n("Are you sure you want to mark all messages in this folder and all its subfolders?"),
                                        i18n("Mark All Recursively")) == KMessageBox::Yes) {
             Akonadi::CollectionFetchJob *job = new Akonadi::CollectionFetchJob(d->mFolders.first());
+            Trace::traceJob(job, "MarkAsCommand::fetchCollections");
             connect(job, &Akonadi::CollectionFetchJob::result, this, &MarkAsCommand::slotCollectionFetchDone);
         } else {
             emitResult(Canceled);
@@ -150,6 +157,7 @@ void MarkAsCommand::execute()
         //yes, we go backwards, shouldn't matter
         Akonadi::ItemFetchJob *job = new Akonadi::ItemFetchJob(d->mFolders[d->mFolderListJobCount - 1], parent());
         job->fetchScope().setAncestorRetrieval(Akonadi::ItemFetchScope::Parent);
+        Trace::traceJob(job, "MarkAsCommand::fetch");
         connect(job, &Akonadi::ItemFetchJob::result, this, &MarkAsCommand::slotFetchDone);
     } else if (!d->mMessages.isEmpty()) {
         d->mFolders << d->mMessages.first().parentCollection();
@@ -170,6 +178,8 @@ void MarkAsCommand::markMessages()
         flag = *(flags.begin());
     }
 
+    Trace::TraceSpan span("MarkAsCommand::prepare");
+    span.setItemCount(d->mMessages.size());
     Akonadi::Item::List itemsToModify;
     foreach (const Akonadi::Item &it, d->mMessages) {
         Akonadi::Item item(it);
@@ -189,6 +199,8 @@ void MarkAsCommand::markMessages()
         }
     }
 
+    span.finish();
+
     d->mMarkJobCount++;
     if (itemsToModify.isEmpty()) {
         slotModifyItemDone(0);   // pretend we did something
@@ -196,6 +208,7 @@ void MarkAsCommand::markMessages()
         Akonadi::ItemModifyJob *modifyJob = new Akonadi::ItemModifyJob(itemsToModify, this);
         modifyJob->setIgnorePayload(true);
         modifyJob->disableRevisionCheck();
+        Trace::traceJob(modifyJob, "MarkAsCommand::modify", itemsToModify.size());
         connect(modifyJob, &Akonadi::ItemModifyJob::result, this, &MarkAsCommand::slotModifyItemDone);
     }
 }
@@ -19,6 +19,7 @@
 
 #include "movecommand.h"
 #include "util_p.h"
+#include "trace_p.h"
 
 #include <itemmovejob.h>
 #include <itemdeletejob.h>
@@ -58,9 +59,11 @@ void MoveCommand::execute()
     }
     if (d->mDestFolder.isValid()) {
         Akonadi::ItemMoveJob *job = new Akonadi::ItemMoveJob(d->mMessages, d->mDestFolder, this);
+        Trace::traceJob(job, "MoveCommand::move", d->mMessages.size());
         connect(job, &Akonadi::ItemMoveJob::result, this, &MoveCommand::slotMoveResult);
     } else {
         Akonadi::ItemDeleteJob *job = new Akonadi::ItemDeleteJob(d->mMessages, this);
+        Trace::traceJob(job, "MoveCommand::delete", d->mMessages.size());
         connect(job, &Akonadi::ItemDeleteJob::result, this, &MoveCommand::slotMoveResult);
     }
 }
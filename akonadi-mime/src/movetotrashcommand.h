@@ -21,6 +21,7 @@
 #define MOVETOTRASHCOMMAND_H
 
 #include "commandbase.h"
+#include "akonadi-mimeprivate_export.h"
 
 #include <collection.h>
 #include <item.h>
@@ -31,7 +32,7 @@ class QAbstractItemModel;
 class KJob;
 namespace Akonadi
 {
-class MoveToTrashCommand : public CommandBase
+class AKONADI_KMIME_TEST_EXPORT MoveToTrashCommand : public CommandBase
 {
     Q_OBJECT
 public:
@@ -20,6 +20,7 @@
 
 #include "removeduplicatesjob.h"
 #include "akonadi_mime_debug.h"
+#include "trace_p.h"
 #include <itemfetchjob.h>
 #include <itemdeletejob.h>
 #include <itemfetchscope.h>
@@ -48,6 +49,7 @@ public:
         Akonadi::ItemFetchJob *job = new Akonadi::ItemFetchJob(collection, mParent);
         job->fetchScope().setAncestorRetrieval(Akonadi::ItemFetchScope::Parent);
         job->fetchScope().fetchFullPayload();
+        Trace::traceJob(job, "RemoveDuplicatesJob::fetch");
         mParent->connect(job, SIGNAL(result(KJob*)), mParent, SLOT(slotFetchDone(KJob*)));
         mCurrentJob = job;
 
@@ -74,6 +76,9 @@ public:
         Akonadi::ItemFetchJob *fjob = static_cast<Akonadi::ItemFetchJob *>(job);
         Akonadi::Item::List items = fjob->items();
 
+        Trace::TraceSpan span("RemoveDuplicatesJob::process");
+        span.setItemCount(items.size());
+
         //find duplicate mails with the same messageid
         //if duplicates are found, check the content as well to be sure they are the same
         QMap<QByteArray, uint> messageIds;
@@ -114,6 +119,7 @@ public:
                 mDuplicateItems.append(items.value(*dupIt));
             }
         }
+        span.finish();
 
         if (mKilled) {
             mParent->emitResult();
@@ -130,6 +136,7 @@ public:
             } else {
                 Q_EMIT mParent->description(mParent, i18n("Removing duplicates..."));
                 Akonadi::ItemDeleteJob *delCmd = new Akonadi::ItemDeleteJob(mDuplicateItems, mParent);
+                Trace::traceJob(delCmd, "RemoveDuplicatesJob::delete", mDuplicateItems.size());
                 mParent->connect(delCmd, SIGNAL(result(KJob*)), mParent, SLOT(slotDeleteDone(KJob*)));
             }
         }
@@ -38,7 +38,16 @@ public:
     SpecialMailCollectionsPrivate();
     ~SpecialMailCollectionsPrivate();
 
+    typedef QHash<Collection::Id, SpecialMailCollections::Type> TypeIndex;
+
+    const TypeIndex &defaultTypeIndex();
+
     SpecialMailCollections *mInstance;
+
+    // Reverse lookup of the default collections, built lazily and
+    // dropped whenever the registration changes.
+    TypeIndex mDefaultTypeIndex;
+    bool mDefaultTypeIndexValid;
 };
 
 typedef SpecialMailCollectionsSettings Settings;
@@ -65,19 +74,44 @@ static inline QByteArray enumToType(SpecialMailCollections::Type value)
     return s_specialCollectionTypes[value];
 }
 
-static inline SpecialMailCollections::Type typeToEnum(const QByteArray &type)
+typedef QHash<QByteArray, SpecialMailCollections::Type> TypeHash;
+
+static TypeHash createTypeHash()
 {
+    TypeHash types;
     for (int i = 0; i < s_numTypes; ++i) {
-        if (type == s_specialCollectionTypes[i]) {
-            return static_cast<SpecialMailCollections::Type>(i);
-        }
+        types.insert(QByteArray(s_specialCollectionTypes[i]), static_cast<SpecialMailCollections::Type>(i));
     }
-    return SpecialMailCollections::Invalid;
+    return types;
+}
+
+Q_GLOBAL_STATIC_WITH_ARGS(TypeHash, sTypeHash, (createTypeHash()))
+
+static inline SpecialMailCollections::Type typeToEnum(const QByteArray &type)
+{
+    return sTypeHash->value(type, SpecialMailCollections::Invalid);
 }
 
 SpecialMailCollectionsPrivate::SpecialMailCollectionsPrivate()
     : mInstance(new SpecialMailCollections(this))
+    , mDefaultTypeIndexValid(false)
+{
+}
+
+const SpecialMailCollectionsPrivate::TypeIndex &SpecialMailCollectionsPrivate::defaultTypeIndex()
 {
+    if (!mDefaultTypeIndexValid) {
+        mDefaultTypeIndex.clear();
+        for (int i = 0; i < s_numTypes; ++i) {
+            const SpecialMailCollections::Type type = static_cast<SpecialMailCollections::Type>(i);
+            const Collection collection = mInstance->defaultCollection(type);
+            if (collection.isValid()) {
+                mDefaultTypeIndex.insert(collection.id(), type);
+            }
+        }
+        mDefaultTypeIndexValid = true;
+    }
+    return mDefaultTypeIndex;
 }
 
 SpecialMailCollectionsPrivate::~SpecialMailCollectionsPrivate()
@@ -99,6 +133,8 @@ SpecialMailCollections::SpecialMailCollections(SpecialMailCollectionsPrivate *dd
     : SpecialCollections(getConfig(QStringLiteral("specialmailcollectionsrc")))
     , d(dd)
 {
+    connect(this, &SpecialCollections::collectionsChanged, this, &SpecialMailCollections::slotCollectionsChanged);
+    connect(this, &SpecialCollections::defaultCollectionsChanged, this, &SpecialMailCollections::slotDefaultCollectionsChanged);
 }
 
 SpecialMailCollections *SpecialMailCollections::self()
@@ -118,12 +154,16 @@ Collection SpecialMailCollections::collection(Type type, const AgentInstance &in
 
 bool SpecialMailCollections::registerCollection(Type type, const Collection &collection)
 {
+    // Registration inside a batch only announces the change at the end of
+    // the batch, so drop the index right away.
+    d->mDefaultTypeIndexValid = false;
     return SpecialCollections::registerCollection(enumToType(type), collection);
 }
 
 bool SpecialMailCollections::unregisterCollection(const Collection &collection)
 {
-    if (collection != Akonadi::SpecialMailCollections::self()->defaultCollection(Akonadi::SpecialMailCollections::Trash)) {
+    if (defaultCollectionType(collection) != Trash) {
+        d->mDefaultTypeIndexValid = false;
         return SpecialCollections::unregisterCollection(collection);
     } else {
         return false;
@@ -178,6 +218,17 @@ void SpecialMailCollections::verifyI18nDefaultCollection(Type type)
     }
 }
 
+void SpecialMailCollections::slotCollectionsChanged(const AgentInstance &instance)
+{
+    Q_UNUSED(instance);
+    d->mDefaultTypeIndexValid = false;
+}
+
+void SpecialMailCollections::slotDefaultCollectionsChanged()
+{
+    d->mDefaultTypeIndexValid = false;
+}
+
 void SpecialMailCollections::slotCollectionModified(KJob *job)
 {
     if (job->error()) {
@@ -194,3 +245,11 @@ SpecialMailCollections::Type SpecialMailCollections::specialCollectionType(const
         return typeToEnum(collection.attribute<SpecialCollectionAttribute>()->collectionType());
     }
 }
+
+SpecialMailCollections::Type SpecialMailCollections::defaultCollectionType(const Akonadi::Collection &collection) const
+{
+    if (!collection.isValid()) {
+        return Invalid;
+    }
+    return d->defaultTypeIndex().value(collection.id(), Invalid);
+}
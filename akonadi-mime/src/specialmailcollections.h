@@ -112,6 +112,18 @@ public:
      */
     static Type specialCollectionType(const Akonadi::Collection &collection);
 
+    /**
+     * Returns the type the given @p collection is registered with as special
+     * mail collection of the default resource, or Invalid if it is not one of
+     * the default collections.
+     *
+     * This is equivalent to comparing @p collection with defaultCollection()
+     * for every type, but uses an index which is kept in sync with
+     * defaultCollectionsChanged().
+     * @since 5.3
+     */
+    Type defaultCollectionType(const Akonadi::Collection &collection) const;
+
     /**
      * Registers the given @p collection as a special mail collection
      * with the given @p type.
@@ -146,6 +158,8 @@ public:
     void verifyI18nDefaultCollection(Type type);
 private Q_SLOTS:
     void slotCollectionModified(KJob *job);
+    void slotCollectionsChanged(const Akonadi::AgentInstance &instance);
+    void slotDefaultCollectionsChanged();
 private:
     //@cond PRIVATE
     friend class SpecialMailCollectionsPrivate;
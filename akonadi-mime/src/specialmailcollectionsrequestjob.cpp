@@ -105,3 +105,24 @@ void SpecialMailCollectionsRequestJob::requestCollection(SpecialMailCollections:
 {
     return SpecialCollectionsRequestJob::requestCollection(enumToType(type), instance);
 }
+
+void SpecialMailCollectionsRequestJob::requestDefaultCollections(const QList<SpecialMailCollections::Type> &types)
+{
+    foreach (SpecialMailCollections::Type type, types) {
+        requestDefaultCollection(type);
+    }
+}
+
+void SpecialMailCollectionsRequestJob::requestCollections(const QList<SpecialMailCollections::Type> &types, const AgentInstance &instance)
+{
+    foreach (SpecialMailCollections::Type type, types) {
+        requestCollection(type, instance);
+    }
+}
+
+void SpecialMailCollectionsRequestJob::requestAllDefaultCollections()
+{
+    for (int type = SpecialMailCollections::Root; type < SpecialMailCollections::LastType; ++type) {
+        requestDefaultCollection(static_cast<SpecialMailCollections::Type>(type));
+    }
+}
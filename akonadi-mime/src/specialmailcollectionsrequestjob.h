@@ -67,6 +67,22 @@ class SpecialMailCollectionsRequestJobPrivate;
  *
  * @endcode
  *
+ * Several collections can be requested with the same job, for example all
+ * default collections needed at startup. They are then resolved and created
+ * in a single pass while the resources are locked, rather than with one job,
+ * lock and discovery per type:
+ *
+ * @code
+ *
+ * SpecialMailCollectionsRequestJob *job = new SpecialMailCollectionsRequestJob( this );
+ * job->requestAllDefaultCollections();
+ * ...
+ *
+ * @endcode
+ *
+ * After the job finished successfully, all requested collections are available
+ * from SpecialMailCollections.
+ *
  * @author Constantin Berzan <exit3219@gmail.com>
  * @since 4.4
 */
@@ -95,6 +111,29 @@ public:
      */
     void requestCollection(SpecialMailCollections::Type type, const AgentInstance &instance);
 
+    /**
+     * Requests the special mail collections of the given @p types in the default resource.
+     *
+     * All of them are resolved or created by this job in one go.
+     * @since 5.3
+     */
+    void requestDefaultCollections(const QList<SpecialMailCollections::Type> &types);
+
+    /**
+     * Requests the special mail collections of the given @p types in the given resource @p instance.
+     *
+     * All of them are resolved or created by this job in one go.
+     * @since 5.3
+     */
+    void requestCollections(const QList<SpecialMailCollections::Type> &types, const AgentInstance &instance);
+
+    /**
+     * Requests all types of special mail collections (root, inbox, outbox, sent-mail,
+     * trash, drafts and templates) in the default resource.
+     * @since 5.3
+     */
+    void requestAllDefaultCollections();
+
 private:
     //@cond PRIVATE
     friend class SpecialMailCollectionsRequestJobPrivate;
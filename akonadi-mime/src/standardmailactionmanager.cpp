@@ -435,12 +435,8 @@ public:
                         canDeleteItem = collection.rights() & Akonadi::Collection::CanDeleteItem;
                     }
                     if (!isSystemFolder) {
-                        isSystemFolder = (collection == SpecialMailCollections::self()->defaultCollection(SpecialMailCollections::Inbox) ||
-                                          collection == SpecialMailCollections::self()->defaultCollection(SpecialMailCollections::Outbox) ||
-                                          collection == SpecialMailCollections::self()->defaultCollection(SpecialMailCollections::SentMail) ||
-                                          collection == SpecialMailCollections::self()->defaultCollection(SpecialMailCollections::Trash) ||
-                                          collection == SpecialMailCollections::self()->defaultCollection(SpecialMailCollections::Drafts) ||
-                                          collection == SpecialMailCollections::self()->defaultCollection(SpecialMailCollections::Templates));
+                        const SpecialMailCollections::Type type = SpecialMailCollections::self()->defaultCollectionType(collection);
+                        isSystemFolder = (type != SpecialMailCollections::Invalid && type != SpecialMailCollections::Root);
                     }
                     //We will not change after that.
                     if (enableMarkAllAsRead && enableMarkAllAsUnread && !canDeleteItem && isSystemFolder) {
@@ -0,0 +1,213 @@
+/*
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "trace_p.h"
+#include "akonadi_mime_debug.h"
+
+#include <itemfetchjob.h>
+
+#include <KJob>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+
+using namespace Akonadi;
+using namespace Akonadi::Trace;
+
+namespace
+{
+
+class TraceWriter
+{
+public:
+    TraceWriter()
+        : mPid(QCoreApplication::applicationPid())
+    {
+        mTimer.start();
+
+        const QString fileName = QFile::decodeName(qgetenv("AKONADI_MIME_TRACE_FILE"));
+        if (fileName.isEmpty()) {
+            return;
+        }
+        mFile.setFileName(fileName);
+        if (!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCWarning(AKONADIMIME_LOG) << "Unable to open trace file" << fileName << ":" << mFile.errorString();
+            return;
+        }
+        // The closing bracket is optional in the Chrome trace format, which
+        // lets us stream events without having to finalize the file.
+        mFile.write("[\n");
+    }
+
+    bool isEnabled() const
+    {
+        return mFile.isOpen();
+    }
+
+    qint64 now() const
+    {
+        return mTimer.nsecsElapsed() / 1000;
+    }
+
+    void writeEvent(char phase, const char *name, qint64 timestamp, qint64 duration,
+                    qint64 asyncId, qint64 itemCount, qint64 bytes)
+    {
+        QByteArray event;
+        event.reserve(192);
+        event += "{\"name\":\"";
+        event += name;
+        event += "\",\"cat\":\"akonadi-mime\",\"ph\":\"";
+        event += phase;
+        event += "\",\"ts\":";
+        event += QByteArray::number(timestamp);
+        if (phase == 'X') {
+            event += ",\"dur\":";
+            event += QByteArray::number(duration);
+        } else {
+            event += ",\"id\":";
+            event += QByteArray::number(asyncId);
+        }
+        event += ",\"pid\":";
+        event += QByteArray::number(mPid);
+        event += ",\"tid\":";
+        event += QByteArray::number(quintptr(QThread::currentThreadId()));
+        if (itemCount >= 0 || bytes >= 0) {
+            event += ",\"args\":{";
+            if (itemCount >= 0) {
+                event += "\"items\":";
+                event += QByteArray::number(itemCount);
+            }
+            if (bytes >= 0) {
+                if (itemCount >= 0) {
+                    event += ',';
+                }
+                event += "\"bytes\":";
+                event += QByteArray::number(bytes);
+            }
+            event += '}';
+        }
+        event += "},\n";
+
+        QMutexLocker locker(&mMutex);
+        mFile.write(event);
+    }
+
+    int nextAsyncId()
+    {
+        return mAsyncId.fetchAndAddRelaxed(1) + 1;
+    }
+
+private:
+    QFile mFile;
+    QMutex mMutex;
+    QElapsedTimer mTimer;
+    QAtomicInt mAsyncId;
+    qint64 mPid;
+};
+
+Q_GLOBAL_STATIC(TraceWriter, s_traceWriter)
+
+class JobSpan : public QObject
+{
+    Q_OBJECT
+public:
+    JobSpan(KJob *job, const char *name, qint64 itemCount)
+        : QObject(job)
+        , mName(name)
+        , mItemCount(itemCount)
+        , mId(s_traceWriter()->nextAsyncId())
+    {
+        s_traceWriter()->writeEvent('b', mName, s_traceWriter()->now(), 0, mId, -1, -1);
+        connect(job, &KJob::finished, this, &JobSpan::slotFinished);
+    }
+
+private Q_SLOTS:
+    void slotFinished(KJob *job)
+    {
+        qint64 bytes = -1;
+        if (Akonadi::ItemFetchJob *fetchJob = qobject_cast<Akonadi::ItemFetchJob *>(job)) {
+            const Akonadi::Item::List items = fetchJob->items();
+            mItemCount = items.count();
+            bytes = 0;
+            foreach (const Akonadi::Item &item, items) {
+                bytes += item.size();
+            }
+        }
+        s_traceWriter()->writeEvent('e', mName, s_traceWriter()->now(), 0, mId, mItemCount, bytes);
+        deleteLater();
+    }
+
+private:
+    const char *mName;
+    qint64 mItemCount;
+    int mId;
+};
+
+}
+
+bool Trace::isEnabled()
+{
+    static const bool enabled = s_traceWriter()->isEnabled();
+    return enabled;
+}
+
+TraceSpan::TraceSpan(const char *name)
+    : mName(name)
+    , mStart(isEnabled() ? s_traceWriter()->now() : -1)
+    , mItemCount(-1)
+    , mBytes(-1)
+{
+}
+
+TraceSpan::~TraceSpan()
+{
+    finish();
+}
+
+void TraceSpan::setItemCount(qint64 count)
+{
+    mItemCount = count;
+}
+
+void TraceSpan::setBytes(qint64 bytes)
+{
+    mBytes = bytes;
+}
+
+void TraceSpan::finish()
+{
+    if (mStart < 0) {
+        return;
+    }
+    const qint64 end = s_traceWriter()->now();
+    s_traceWriter()->writeEvent('X', mName, mStart, end - mStart, 0, mItemCount, mBytes);
+    mStart = -1;
+}
+
+void Trace::traceJob(KJob *job, const char *name, qint64 itemCount)
+{
+    if (!isEnabled() || !job) {
+        return;
+    }
+    new JobSpan(job, name, itemCount);
+}
+
+#include "trace.moc"
@@ -0,0 +1,90 @@
+/*
+    This library is free software; you can redistribute it and/or modify it
+    under the terms of the GNU Library General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This library is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+    License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to the
+    Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef AKONADI_TRACE_P_H
+#define AKONADI_TRACE_P_H
+
+#include <QtCore/QtGlobal>
+
+class KJob;
+
+namespace Akonadi
+{
+
+/**
+ * @internal
+ *
+ * Lightweight tracing of the hot paths of the mail jobs and commands.
+ *
+ * Tracing is enabled by pointing the AKONADI_MIME_TRACE_FILE environment
+ * variable to a file. Spans are then written to it in the Chrome trace
+ * event format, which can be loaded into chrome://tracing or Perfetto.
+ * When the variable is not set, every call below returns after checking
+ * a single flag.
+ */
+namespace Trace
+{
+
+/**
+ * Returns whether tracing was enabled for this process.
+ */
+bool isEnabled();
+
+/**
+ * A span covering the lifetime of a scope, or the time between
+ * construction and finish().
+ *
+ * @p name must be a string literal, it is not copied.
+ */
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name);
+    ~TraceSpan();
+
+    void setItemCount(qint64 count);
+    void setBytes(qint64 bytes);
+
+    /**
+     * Ends the span early. Does nothing if it was already finished.
+     */
+    void finish();
+
+private:
+    Q_DISABLE_COPY(TraceSpan)
+
+    const char *mName;
+    qint64 mStart;
+    qint64 mItemCount;
+    qint64 mBytes;
+};
+
+/**
+ * Traces @p job from now until it finishes, as an asynchronous span
+ * that may overlap with others.
+ *
+ * @p itemCount is the number of items the job works on, if known.
+ * For item fetch jobs the number of fetched items and their size
+ * are recorded instead.
+ */
+void traceJob(KJob *job, const char *name, qint64 itemCount = -1);
+
+}
+
+}
+
+#endif
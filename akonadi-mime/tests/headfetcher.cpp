@@ -27,7 +27,6 @@
 
 #include <QtCore/QDebug>
 #include <QApplication>
-#include <QTimer>
 
 #include <kmime/kmime_message.h>
 
@@ -38,35 +37,133 @@
 
 using namespace Akonadi;
 
-HeadFetcher::HeadFetcher(bool multipart)
+HeadFetcher::HeadFetcher(const QStringList &modes, int rounds, int concurrency)
+    : mConcurrency(qMax(1, concurrency))
+    , mNextCollection(0)
+    , mRunningJobs(0)
+    , mItems(0)
+    , mBytes(0)
+    , mSubjects(0)
+    , mAccountingNsecs(0)
 {
-    // fetch all headers from each folder
-    timer.start();
-    qDebug() << "Listing all headers of every folder, using" << (multipart ? "multi" : "single") << "part.";
-    CollectionFetchJob *clj = new CollectionFetchJob(Collection::root(), CollectionFetchJob::Recursive);
-    clj->exec();
-    Collection::List list = clj->collections();
-    foreach (const Collection &collection, list) {
-        ItemFetchJob *ifj = new ItemFetchJob(collection, this);
-        if (multipart) {
-            ifj->fetchScope().fetchPayloadPart(MessagePart::Envelope);
-        } else {
-            ifj->fetchScope().fetchFullPayload();
+    // rotate the order in every round
+    for (int round = 0; round < rounds; ++round) {
+        for (int i = 0; i < modes.count(); ++i) {
+            mModes << modes.at((round + i) % modes.count());
         }
-        ifj->exec();
-        qDebug() << "  Listing" << ifj->items().count() << "item headers.";
-        foreach (const Item &item, ifj->items()) {
-            qDebug() << item.payload<KMime::Message::Ptr>()->subject()->asUnicodeString();
+    }
+
+    CollectionFetchJob *job = new CollectionFetchJob(Collection::root(), CollectionFetchJob::Recursive, this);
+    connect(job, &CollectionFetchJob::result, this, &HeadFetcher::slotCollectionsFetched);
+}
+
+void HeadFetcher::slotCollectionsFetched(KJob *job)
+{
+    if (job->error()) {
+        qWarning() << "Unable to list collections:" << job->errorString();
+        stop(1);
+        return;
+    }
+
+    foreach (const Collection &collection, static_cast<CollectionFetchJob *>(job)->collections()) {
+        if (collection.contentMimeTypes().contains(KMime::Message::mimeType())) {
+            mCollections << collection;
+        }
+    }
+    qDebug() << "Fetching" << mCollections.count() << "mail folders," << mConcurrency << "at a time.";
+
+    startMode();
+}
+
+void HeadFetcher::startMode()
+{
+    if (mModes.isEmpty()) {
+        stop(0);
+        return;
+    }
+
+    mNextCollection = 0;
+    mItems = 0;
+    mBytes = 0;
+    mSubjects = 0;
+    mAccountingNsecs = 0;
+    mTimer.start();
+
+    for (int i = 0; i < mConcurrency && mNextCollection < mCollections.count(); ++i) {
+        startNextFetch();
+    }
+    if (mRunningJobs == 0) {
+        finishMode();
+    }
+}
+
+void HeadFetcher::startNextFetch()
+{
+    const QString mode = mModes.first();
+    ItemFetchJob *job = new ItemFetchJob(mCollections.at(mNextCollection++), this);
+    if (mode == QLatin1String("envelope")) {
+        job->fetchScope().fetchPayloadPart(MessagePart::Envelope);
+    } else if (mode == QLatin1String("header")) {
+        job->fetchScope().fetchPayloadPart(MessagePart::Header);
+    } else {
+        job->fetchScope().fetchFullPayload();
+    }
+    connect(job, &ItemFetchJob::result, this, &HeadFetcher::slotItemsFetched);
+    ++mRunningJobs;
+}
+
+void HeadFetcher::slotItemsFetched(KJob *job)
+{
+    --mRunningJobs;
+    if (job->error()) {
+        qWarning() << "Item fetch failed:" << job->errorString();
+    } else {
+        const Item::List items = static_cast<ItemFetchJob *>(job)->items();
+        mItems += items.count();
+        foreach (const Item &item, items) {
+            if (!item.hasPayload<KMime::Message::Ptr>()) {
+                continue;
+            }
+            // Access the subject so that the payload is deserialized, as a
+            // message list would do, without paying for logging it.
+            const KMime::Message::Ptr message = item.payload<KMime::Message::Ptr>();
+            if (!message->subject()->isEmpty()) {
+                ++mSubjects;
+            }
+
+            // Count the size of the content that was actually loaded for the
+            // fetched parts, rather than the stored size of the full message.
+            // Encoding it again is not part of fetching, so it is not timed.
+            QElapsedTimer accounting;
+            accounting.start();
+            mBytes += message->encodedContent().size();
+            mAccountingNsecs += accounting.nsecsElapsed();
         }
     }
 
-    qDebug() << "Took:" << timer.elapsed() << "ms.";
-    QTimer::singleShot(1000, this, SLOT(stop()));
+    if (mNextCollection < mCollections.count()) {
+        startNextFetch();
+    } else if (mRunningJobs == 0) {
+        finishMode();
+    }
+}
+
+void HeadFetcher::finishMode()
+{
+    const qint64 msecs = qMax<qint64>(1, (mTimer.nsecsElapsed() - mAccountingNsecs) / 1000000);
+    const double seconds = msecs / 1000.0;
+    qDebug().nospace() << qPrintable(mModes.first()) << ": "
+                       << mItems << " items (" << mSubjects << " with subject) in " << msecs << " ms, "
+                       << qRound(mItems / seconds) << " items/s, "
+                       << (mBytes / (1024.0 * 1024.0)) / seconds << " MB/s";
+
+    mModes.removeFirst();
+    startMode();
 }
 
-void HeadFetcher::stop()
+void HeadFetcher::stop(int exitCode)
 {
-    qApp->quit();
+    qApp->exit(exitCode);
 }
 
 int main(int argc, char *argv[])
@@ -78,16 +175,33 @@ int main(int argc, char *argv[])
     KAboutData::setApplicationData(aboutData);
     parser.addVersionOption();
     parser.addHelpOption();
-    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("multipart"), i18n("Run test on multipart data (default is singlepart).")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("modes"),
+                                        i18n("Comma separated fetch modes to compare: envelope, header, full (default: all of them)."),
+                                        QStringLiteral("modes"), QStringLiteral("envelope,header,full")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("rounds"),
+                                        i18n("Number of times every mode is run, with the order of the modes rotated each time (default: the number of modes)."),
+                                        QStringLiteral("count")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("concurrency"),
+                                        i18n("Number of folders fetched at the same time (default: 4)."),
+                                        QStringLiteral("count"), QStringLiteral("4")));
 
     //PORTING SCRIPT: adapt aboutdata variable if necessary
     aboutData.setupCommandLine(&parser);
     parser.process(app);
     aboutData.processCommandLine(&parser);
 
-    bool multipart = parser.isSet(QStringLiteral("multipart"));
+    const QStringList validModes = QStringList() << QStringLiteral("envelope") << QStringLiteral("header") << QStringLiteral("full");
+    const QStringList modes = parser.value(QStringLiteral("modes")).split(QLatin1Char(','), QString::SkipEmptyParts);
+    foreach (const QString &mode, modes) {
+        if (!validModes.contains(mode)) {
+            qWarning() << "Unknown fetch mode" << mode;
+            return 1;
+        }
+    }
+
+    const int rounds = parser.isSet(QStringLiteral("rounds")) ? qMax(1, parser.value(QStringLiteral("rounds")).toInt()) : modes.count();
 
-    HeadFetcher d(multipart);
+    HeadFetcher d(modes, rounds, parser.value(QStringLiteral("concurrency")).toInt());
 
     return app.exec();
 }
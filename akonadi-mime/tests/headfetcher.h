@@ -20,18 +20,47 @@
 #ifndef HEADFETCHER_H
 #define HEADFETCHER_H
 
+#include <collection.h>
+
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QObject>
-#include <QtCore/QTime>
+#include <QtCore/QStringList>
+
+class KJob;
 
+/**
+ * Measures item fetch throughput of all mail folders for a set of
+ * fetch modes ("envelope", "header" and "full"), running up to a given
+ * number of folder fetches concurrently.
+ *
+ * The modes are run in several rounds, with the order rotated in every
+ * round, so that each mode is measured both before and after the server
+ * caches were warmed up by the other modes.
+ */
 class HeadFetcher : public QObject
 {
     Q_OBJECT
 public:
-    HeadFetcher(bool multipart);
+    HeadFetcher(const QStringList &modes, int rounds, int concurrency);
 private Q_SLOTS:
-    void stop();
+    void slotCollectionsFetched(KJob *job);
+    void slotItemsFetched(KJob *job);
 private:
-    QTime timer;
+    void startMode();
+    void startNextFetch();
+    void finishMode();
+    void stop(int exitCode);
+
+    QStringList mModes;
+    int mConcurrency;
+    Akonadi::Collection::List mCollections;
+    int mNextCollection;
+    int mRunningJobs;
+    qint64 mItems;
+    qint64 mBytes;
+    qint64 mSubjects;
+    qint64 mAccountingNsecs;
+    QElapsedTimer mTimer;
 };
 
 #endif